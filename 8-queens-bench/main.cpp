@@ -0,0 +1,504 @@
+#define NTF_ALLOCATION_TRACKING_IMPLEMENTATION
+#include "BeamSearch.h"
+#include "TabuSearch.h"
+#include "MinConflicts.h"
+#include "Portfolio.h"
+#include "Backtracking.h"
+#include "ParallelCount.h"
+#include "SolutionsFile.h"
+#include "BulkTest.h"
+#include "LocalThreats.h"
+#include "GlobalThreats.h"
+#include <cstdio>
+#include <cstring>
+
+
+constexpr uint32_t DEFAULT_BENCH_BOARD_SIZE = 8U;
+
+// Headless counterpart of the bulk tests, prints one row of the readme result
+// tables for the given configuration.
+struct BenchOptions {
+	std::string solver = "beam";
+	std::string heuristic = "local";
+	std::string format = "csv";
+	std::string tracePath = "";
+	std::string enumeratePath = "";
+	std::string readPath = "";
+	ntf::SolutionsEncoding encoding = ntf::SolutionsEncoding::DELTA;
+	ntf::FigureKind figure = ntf::FigureKind::QUEEN;
+	int32_t param = INT32_MIN;
+	uint32_t size = DEFAULT_BENCH_BOARD_SIZE;
+	uint32_t iterations = 1000;
+	uint64_t seed = 1;
+	size_t threads = ntf::ThreadPool::DefaultThreadsCount();
+	uint64_t timeoutMs = 10000;
+	bool header = true;
+	bool count = false;
+};
+
+static void PrintUsage(const char* program)
+{
+	std::fprintf(
+		stderr,
+		"Usage: %s [options]\n"
+		"  --solver <beam|tabu|tabu-moves|min-conflicts|portfolio|backtracking>  (default beam)\n"
+		"  --heuristic <local|global>                                           (default local)\n"
+		"  --figure <bishop|king|knight|pawn|queen|rook>                        (default queen)\n"
+		"  --param <value>       solver param, defaults to the one of the visualization\n"
+		"  --size <N>            board size (default 8)\n"
+		"  --iterations <count>  amount of solved random boards (default 1000)\n"
+		"  --seed <value>        seed of the random boards and solvers (default 1)\n"
+		"  --threads <count>     worker threads (default: hardware threads)\n"
+		"  --timeout-ms <ms>     time limit of a single solve (default 10000)\n"
+		"  --format <csv|json>   output format (default csv)\n"
+		"  --trace <file>        write a Chrome trace of the run (builds with NTF_TRACING)\n"
+		"  --no-header           omit the CSV header\n"
+		"  --count               count all solutions of the board size by backtracking on all\n"
+		"                        threads instead, within the timeout\n"
+		"  --enumerate <file>    write all solutions of the board size to the file instead\n"
+		"  --encoding <packed|delta>  encoding of the enumerated solutions (default delta)\n"
+		"  --read <file>         read the solutions of the file and check every one of them\n",
+		program
+	);
+}
+
+static bool ParseUnsigned(const char* text, uint64_t& value)
+{
+	char* end = nullptr;
+	value = std::strtoull(text, &end, 10);
+	return end != text && *end == '\0' && text[0] != '-';
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions& options)
+{
+	for (int i = 1; i < argc; i++) {
+		std::string option = argv[i];
+
+		if (option == "--no-header") {
+			options.header = false;
+			continue;
+		}
+
+		if (option == "--count") {
+			options.count = true;
+			continue;
+		}
+
+		if (option == "--help" || i + 1 >= argc)
+			return false;
+
+		const char* value = argv[++i];
+		uint64_t number = 0;
+
+		if (option == "--solver")
+			options.solver = value;
+
+		else if (option == "--heuristic")
+			options.heuristic = value;
+
+		else if (option == "--format")
+			options.format = value;
+
+		else if (option == "--trace")
+			options.tracePath = value;
+
+		else if (option == "--enumerate")
+			options.enumeratePath = value;
+
+		else if (option == "--read")
+			options.readPath = value;
+
+		else if (option == "--encoding") {
+			if (!ntf::ParseSolutionsEncoding(value, options.encoding))
+				return false;
+		}
+
+		else if (option == "--figure") {
+			if (!ntf::ParseFigureKind(value, options.figure))
+				return false;
+		}
+
+		else if (option == "--param") {
+			char* end = nullptr;
+			long param = std::strtol(value, &end, 10);
+
+			if (end == value || *end != '\0')
+				return false;
+
+			options.param = static_cast<int32_t>(param);
+		}
+
+		else if (!ParseUnsigned(value, number))
+			return false;
+
+		else if (option == "--size")
+			options.size = static_cast<uint32_t>(number);
+
+		else if (option == "--iterations")
+			options.iterations = static_cast<uint32_t>(number);
+
+		else if (option == "--seed")
+			options.seed = number;
+
+		else if (option == "--threads")
+			options.threads = std::max<size_t>(static_cast<size_t>(number), 1);
+
+		else if (option == "--timeout-ms")
+			options.timeoutMs = number;
+
+		else
+			return false;
+	}
+
+	if (!options.tracePath.empty() && !ntf::TRACING_ENABLED) {
+		std::fprintf(stderr, "--trace needs a build with NTF_TRACING\n");
+		return false;
+	}
+
+	return options.size > 0 && (options.format == "csv" || options.format == "json");
+}
+
+// Solvers with the same params as in the visualization. Beam search expands on
+// the pool of the bulk tests, that is on the cores they leave idle.
+static std::shared_ptr<ntf::Solver> CreateSolver(const std::string& name, const std::shared_ptr<ntf::ThreadPool>& threadPool)
+{
+	if (name == "beam")
+		return std::make_shared<ntf::BeamSearch>(ntf::SolverParam{ true, "K param", 2, 1000, 16, 16, }, threadPool);
+
+	if (name == "tabu")
+		return std::make_shared<ntf::TabuSearch>(ntf::SolverParam{ true, "Tabu list max size", 2, 1000, 16, 16, });
+
+	if (name == "tabu-moves")
+		return std::make_shared<ntf::TabuSearch>(ntf::SolverParam{ true, "Tabu tenure", 1, 1000, 8, 8, }, ntf::TabuMode::MOVES);
+
+	if (name == "min-conflicts")
+		return std::make_shared<ntf::MinConflicts>(ntf::SolverParam{ true, "Samples per move", 1, 1000, 32, 32, });
+
+	if (name == "backtracking")
+		return std::make_shared<ntf::Backtracking>();
+
+	if (name == "portfolio") {
+		return std::make_shared<ntf::Portfolio>(std::vector<std::shared_ptr<ntf::Solver>>{
+			std::make_shared<ntf::BeamSearch>(ntf::SolverParam{ true, "K param", 2, 1000, 16, 16, }, threadPool),
+			std::make_shared<ntf::BeamSearch>(ntf::SolverParam{ true, "K param", 2, 1000, 48, 48, }, threadPool),
+			std::make_shared<ntf::TabuSearch>(ntf::SolverParam{ true, "Tabu list max size", 2, 1000, 16, 16, }),
+			std::make_shared<ntf::TabuSearch>(ntf::SolverParam{ true, "Tabu tenure", 1, 1000, 8, 8, }, ntf::TabuMode::MOVES),
+		});
+	}
+
+	return nullptr;
+}
+
+static std::shared_ptr<ntf::Heuristic> CreateHeuristic(const std::string& name)
+{
+	if (name == "local")
+		return std::make_shared<ntf::LocalThreats>();
+
+	if (name == "global")
+		return std::make_shared<ntf::GlobalThreats>();
+
+	return nullptr;
+}
+
+static std::string EscapeJson(const std::string& text)
+{
+	std::string escaped{};
+
+	for (char character : text) {
+		if (character == '"' || character == '\\')
+			escaped.push_back('\\');
+		escaped.push_back(character);
+	}
+
+	return escaped;
+}
+
+// Column of the output, text values are quoted in JSON.
+struct BenchField {
+	std::string name;
+	std::string value;
+	bool isText = false;
+};
+
+static BenchField TextField(const std::string& name, const std::string& value)
+{
+	return { name, value, true };
+}
+
+template<typename T>
+static BenchField NumberField(const std::string& name, T value)
+{
+	return { name, std::to_string(value) };
+}
+
+// Percentiles of a histogram as <prefix>_<suffix> columns.
+static void AddPercentileFields(
+	std::vector<BenchField>& fields,
+	const std::string& prefix,
+	const std::string& suffix,
+	const ntf::Histogram& histogram,
+	std::initializer_list<std::pair<const char*, double>> percentiles
+) {
+	for (auto& [name, percentile] : percentiles)
+		fields.push_back(NumberField(prefix + "_" + name + suffix, histogram.Percentile(percentile)));
+}
+
+static void PrintFields(const std::vector<BenchField>& fields, const BenchOptions& options)
+{
+	std::string output{};
+
+	if (options.format == "csv") {
+		if (options.header) {
+			for (size_t i = 0; i < fields.size(); i++)
+				output += (i > 0 ? "," : "") + fields[i].name;
+			output += "\n";
+		}
+
+		for (size_t i = 0; i < fields.size(); i++)
+			output += (i > 0 ? "," : "") + fields[i].value;
+	}
+
+	else {
+		for (size_t i = 0; i < fields.size(); i++) {
+			std::string value = fields[i].isText ? "\"" + EscapeJson(fields[i].value) + "\"" : fields[i].value;
+			output += (i > 0 ? "," : "{") + ("\"" + fields[i].name + "\":") + value;
+		}
+
+		output += "}";
+	}
+
+	std::printf("%s\n", output.c_str());
+}
+
+// Counts the solutions of an empty board instead of solving random ones, which
+// is the CPU scaling benchmark of the project.
+static std::vector<BenchField> CountFields(const BenchOptions& options)
+{
+	ntf::SolveContext context = ntf::SolveContext::WithTimeout(std::chrono::milliseconds(options.timeoutMs));
+	context.figure = options.figure;
+
+	ntf::ParallelSolutionsCounter counter(options.threads);
+	ntf::SolutionsCount count = counter.Count(options.size, context);
+
+	double seconds = std::max(static_cast<double>(count.duration.count()) / 1e6, 1e-6);
+
+	return {
+		TextField("solver", "Backtracking"),
+		TextField("figure", ntf::FigureKindName(options.figure)),
+		NumberField("board_size", options.size),
+		NumberField("solutions", count.solutionsCount),
+		NumberField("nodes", count.nodesCount),
+		NumberField("duration_us", static_cast<long long>(count.duration.count())),
+		NumberField("timed_out", count.timedOut ? 1 : 0),
+		NumberField("solutions_per_second", static_cast<uint64_t>(count.solutionsCount / seconds)),
+		NumberField("nodes_per_second", static_cast<uint64_t>(count.nodesCount / seconds)),
+		NumberField("threads", options.threads),
+	};
+}
+
+// Writes every solution of an empty board in lexicographic order to the file,
+// while the writer thread of the file keeps the disk busy.
+static bool EnumerateFields(const BenchOptions& options, std::vector<BenchField>& fields)
+{
+	ntf::SolveContext context = ntf::SolveContext::WithTimeout(std::chrono::milliseconds(options.timeoutMs));
+	context.figure = options.figure;
+
+	ntf::SolutionsWriter writer;
+
+	if (options.size > ntf::MAX_BACKTRACKING_SIZE || !writer.Open(options.enumeratePath, options.encoding, options.figure, options.size))
+		return false;
+
+	ntf::SolutionsCount count = ntf::Backtracking::EnumerateSolutions(options.size, context, [&](const ntf::Board& solution) {
+		writer.Write(solution);
+	});
+
+	if (!writer.Close())
+		return false;
+
+	double seconds = std::max(static_cast<double>(count.duration.count()) / 1e6, 1e-6);
+	double bytesPerSolution = static_cast<double>(writer.BytesCount() - ntf::SOLUTIONS_HEADER_SIZE) / std::max<uint64_t>(count.solutionsCount, 1);
+
+	fields = {
+		TextField("figure", ntf::FigureKindName(options.figure)),
+		NumberField("board_size", options.size),
+		TextField("encoding", ntf::SolutionsEncodingName(options.encoding)),
+		NumberField("solutions", count.solutionsCount),
+		NumberField("nodes", count.nodesCount),
+		NumberField("bytes", writer.BytesCount()),
+		NumberField("bytes_per_solution", bytesPerSolution),
+		NumberField("duration_us", static_cast<long long>(count.duration.count())),
+		NumberField("timed_out", count.timedOut ? 1 : 0),
+		NumberField("solutions_per_second", static_cast<uint64_t>(count.solutionsCount / seconds)),
+	};
+
+	return true;
+}
+
+// Streams the solutions of the file back, checking that every one of them is
+// a solution and that they are strictly increasing.
+static bool ReadFields(const BenchOptions& options, std::vector<BenchField>& fields)
+{
+	ntf::SolutionsReader reader;
+
+	if (!reader.Open(options.readPath))
+		return false;
+
+	auto startTime = ntf::HighResClock::now();
+
+	ntf::Board solution;
+	ntf::Board previous;
+	uint64_t invalidCount = 0;
+
+	while (reader.Next(solution)) {
+		bool ordered = reader.SolutionsCount() == 1 || previous < solution;
+
+		if (!ordered || ntf::ThreatCounters(solution, reader.Figure()).ConflictsCount() != 0)
+			invalidCount++;
+
+		previous = solution;
+	}
+
+	if (reader.Failed())
+		return false;
+
+	ntf::Microseconds duration = ntf::Solver::TakeTimeStamp(startTime);
+
+	fields = {
+		TextField("figure", ntf::FigureKindName(reader.Figure())),
+		NumberField("board_size", reader.Size()),
+		TextField("encoding", ntf::SolutionsEncodingName(reader.Encoding())),
+		NumberField("solutions", reader.SolutionsCount()),
+		NumberField("invalid_solutions", invalidCount),
+		NumberField("bytes", reader.BytesCount()),
+		NumberField("duration_us", static_cast<long long>(duration.count())),
+	};
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options{};
+
+	if (!ParseOptions(argc, argv, options)) {
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	if (options.count) {
+		PrintFields(CountFields(options), options);
+		return 0;
+	}
+
+	if (!options.enumeratePath.empty() || !options.readPath.empty()) {
+		std::vector<BenchField> fields;
+		bool enumerating = !options.enumeratePath.empty();
+		const std::string& path = enumerating ? options.enumeratePath : options.readPath;
+
+		if (!(enumerating ? EnumerateFields(options, fields) : ReadFields(options, fields))) {
+			std::fprintf(stderr, "Cannot %s the solutions file %s\n", enumerating ? "write" : "read", path.c_str());
+			return 1;
+		}
+
+		PrintFields(fields, options);
+		return 0;
+	}
+
+	std::shared_ptr<ntf::ThreadPool> threadPool(std::make_shared<ntf::ThreadPool>(options.threads));
+	std::shared_ptr<ntf::Solver> solver(CreateSolver(options.solver, threadPool));
+	std::shared_ptr<ntf::Heuristic> heuristic(CreateHeuristic(options.heuristic));
+
+	if (!solver || !heuristic) {
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	if (options.size > solver->MaxBoardSize()) {
+		std::fprintf(stderr, "%s supports boards up to %u\n", solver->name.c_str(), solver->MaxBoardSize());
+		return 1;
+	}
+
+	ntf::SolverParam param = solver->param;
+
+	if (options.param != INT32_MIN)
+		param.value = options.param;
+
+	if (!options.tracePath.empty())
+		ntf::Tracer::Instance().Start();
+
+	auto startTime = ntf::HighResClock::now();
+
+	ntf::BulkTestRunner runner(threadPool);
+	runner.Start(solver, param, heuristic, options.size, options.figure, options.iterations, std::chrono::milliseconds(options.timeoutMs), options.seed);
+
+	ntf::BulkTestInfo info = runner.Wait();
+	auto wallDuration = ntf::Solver::TakeTimeStamp(startTime);
+
+	if (!options.tracePath.empty()) {
+		ntf::Tracer::Instance().Stop();
+
+		if (!ntf::Tracer::Instance().WriteChromeTrace(options.tracePath))
+			std::fprintf(stderr, "Cannot write the trace to %s\n", options.tracePath.c_str());
+	}
+
+	uint32_t averagedIterations = std::max(info.passedIterations, 1U);
+	double solvingSeconds = std::max(static_cast<double>(info.totalDuration) / 1e6, 1e-6);
+	std::string paramName = param.isUsed ? param.name : "";
+
+	std::vector<BenchField> fields{
+		TextField("solver", solver->name),
+		TextField("param_name", paramName),
+		NumberField("param", param.value),
+		TextField("heuristic", heuristic->name),
+		TextField("figure", ntf::FigureKindName(options.figure)),
+		NumberField("board_size", options.size),
+		NumberField("iterations", info.currentIteration),
+		NumberField("failed_iterations", info.failedIterations),
+		NumberField("avg_duration_us", info.totalDuration / averagedIterations),
+		NumberField("avg_nodes", info.totalStatesGenerated / averagedIterations),
+		NumberField("moves", info.totalMoves),
+		NumberField("moves_per_s", static_cast<uint64_t>(info.totalMoves / solvingSeconds)),
+	};
+
+	AddPercentileFields(fields, "duration", "_us", info.durations, {
+		{ "min", 0.0 }, { "p50", 50.0 }, { "p90", 90.0 }, { "p99", 99.0 }, { "p999", 99.9 }, { "max", 100.0 },
+	});
+	fields.push_back(NumberField("duration_stddev_us", static_cast<uint64_t>(info.durations.StdDev())));
+
+	AddPercentileFields(fields, "nodes", "", info.statesCounts, { { "p50", 50.0 }, { "p99", 99.0 }, { "max", 100.0 } });
+
+	fields.push_back(NumberField("failure_duration_avg_us", static_cast<uint64_t>(info.failureDurations.Mean())));
+	AddPercentileFields(fields, "failure_duration", "_us", info.failureDurations, { { "p50", 50.0 }, { "max", 100.0 } });
+
+	fields.push_back(NumberField("solutions_checksum", info.solutionsChecksum));
+
+	// Averages over all runs, the counters only exist in builds with solver stats.
+	if constexpr (ntf::SOLVER_STATS_ENABLED) {
+		const ntf::SolverStats& stats = info.stats;
+		uint32_t runsCount = std::max(info.currentIteration, 1U);
+
+		fields.push_back(NumberField("avg_iterations", stats.iterationsCount / runsCount));
+		fields.push_back(NumberField("avg_heuristic_evaluations", stats.heuristicEvaluationsCount / runsCount));
+		fields.push_back(NumberField("avg_visited_lookups", stats.visitedLookupsCount / runsCount));
+		fields.push_back(NumberField("avg_visited_hits", stats.visitedHitsCount / runsCount));
+		fields.push_back(NumberField("avg_duplicates", stats.duplicatesCount / runsCount));
+		fields.push_back(NumberField("avg_queue_pushes", stats.queuePushesCount / runsCount));
+		fields.push_back(NumberField("avg_queue_pops", stats.queuePopsCount / runsCount));
+		fields.push_back(NumberField("peak_frontier_size", stats.peakFrontierSize));
+	}
+
+	if constexpr (ntf::ALLOCATION_TRACKING_ENABLED) {
+		const ntf::AllocationStats& allocations = info.allocations;
+		uint32_t runsCount = std::max(info.currentIteration, 1U);
+
+		fields.push_back(NumberField("avg_allocations", allocations.allocationsCount / runsCount));
+		fields.push_back(NumberField("avg_allocated_bytes", allocations.allocatedBytes / runsCount));
+		fields.push_back(NumberField("peak_live_bytes", allocations.peakLiveBytes));
+	}
+	fields.push_back(NumberField("threads", options.threads));
+	fields.push_back(NumberField("wall_duration_us", static_cast<long long>(wallDuration.count())));
+
+	PrintFields(fields, options);
+
+	return 0;
+}
@@ -0,0 +1,205 @@
+// Always built with allocation tracking, so a kernel can be reported in
+// allocations per call next to its speed.
+#define NTF_ALLOCATION_TRACKING 1
+#define NTF_ALLOCATION_TRACKING_IMPLEMENTATION
+#include "AllocationTracking.h"
+#include "Solver.h"
+#include "Threats.h"
+#include "LocalThreats.h"
+#include "GlobalThreats.h"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+
+constexpr uint32_t MICROBENCH_DEFAULT_MAX_SIZE = 4096U;
+constexpr uint64_t MICROBENCH_DEFAULT_MIN_TIME_MS = 50U;
+constexpr uint64_t MICROBENCH_BATCH_CALLS = 64U;
+
+enum class BoardKind { RANDOM, SAME_ROW, DIAGONAL };
+
+struct MicrobenchResult {
+	double nsPerCall = 0.0;
+	double callsPerSecond = 0.0;
+	double allocationsPerCall = 0.0;
+};
+
+// Results of the kernels are summed here, so the compiler cannot drop the calls.
+static volatile uint64_t sink = 0;
+
+static std::string BoardKindName(BoardKind kind)
+{
+	switch (kind) {
+	case BoardKind::SAME_ROW: return "same-row";
+	case BoardKind::DIAGONAL: return "diagonal";
+	default: return "random";
+	}
+}
+
+// Random boards are the typical input, the adversarial ones put every figure on
+// one row or on the main diagonal, so every figure attacks all the others.
+static ntf::Board CreateBoard(BoardKind kind, uint32_t size, std::mt19937_64& randomEngine)
+{
+	ntf::Board board(size);
+	std::uniform_int_distribution<uint32_t> distribution(0, size - 1);
+
+	for (uint32_t col = 0; col < size; col++) {
+		if (kind == BoardKind::RANDOM)
+			board.SetRow(col, distribution(randomEngine));
+		else if (kind == BoardKind::DIAGONAL)
+			board.SetRow(col, col);
+	}
+
+	return board;
+}
+
+// Calls the kernel in batches until minTime elapses. The argument is the call
+// index, which kernels use to walk over the columns of the board.
+template<typename Kernel>
+static MicrobenchResult Measure(Kernel&& kernel, ntf::Microseconds minTime)
+{
+	uint64_t callsCount = 0;
+	uint64_t checksum = 0;
+
+	ntf::AllocationCounters allocationCounters;
+	ntf::AllocationScope allocationScope(&allocationCounters);
+
+	auto startTime = ntf::HighResClock::now();
+	auto elapsed = ntf::HighResClock::duration::zero();
+
+	do {
+		for (uint64_t i = 0; i < MICROBENCH_BATCH_CALLS; i++)
+			checksum += kernel(callsCount + i);
+
+		callsCount += MICROBENCH_BATCH_CALLS;
+		elapsed = ntf::HighResClock::now() - startTime;
+	} while (elapsed < minTime);
+
+	uint64_t allocationsCount = allocationCounters.Stats().allocationsCount;
+	sink = sink + checksum;
+
+	double seconds = std::chrono::duration<double>(elapsed).count();
+
+	return {
+		seconds * 1e9 / callsCount,
+		callsCount / seconds,
+		static_cast<double>(allocationsCount) / callsCount,
+	};
+}
+
+static void PrintResult(
+	const std::string& kernel,
+	const std::string& heuristic,
+	BoardKind kind,
+	uint32_t size,
+	const MicrobenchResult& result
+) {
+	std::printf(
+		"%s,%s,%s,%u,%.1f,%.0f,%.2f\n",
+		kernel.c_str(),
+		heuristic.c_str(),
+		BoardKindName(kind).c_str(),
+		size,
+		result.nsPerCall,
+		result.callsPerSecond,
+		result.allocationsPerCall
+	);
+	std::fflush(stdout);
+}
+
+static void RunKernels(
+	const std::vector<std::shared_ptr<ntf::Heuristic>>& heuristics,
+	BoardKind kind,
+	uint32_t size,
+	ntf::Microseconds minTime,
+	std::mt19937_64& randomEngine
+) {
+	const ntf::Board board = CreateBoard(kind, size, randomEngine);
+	const ntf::ThreatCounters counters(board);
+
+	for (auto& heuristic : heuristics) {
+		PrintResult("EvaluatePosition", heuristic->name, kind, size, Measure([&](uint64_t i) {
+			uint32_t col = static_cast<uint32_t>(i % size);
+			return heuristic->EvaluatePosition(ntf::Square(col, (board.Row(col) + 1) % size), board).value;
+		}, minTime));
+
+		PrintResult("EvaluateBoard", heuristic->name, kind, size, Measure([&](uint64_t) {
+			return heuristic->EvaluateBoard(board);
+		}, minTime));
+
+		PrintResult("EvaluateColumn", heuristic->name, kind, size, Measure([&](uint64_t i) {
+			return heuristic->EvaluateColumn(board.Position(static_cast<uint32_t>(i % size)), board).size();
+		}, minTime));
+
+		PrintResult("EvaluateMove (counters)", heuristic->name, kind, size, Measure([&](uint64_t i) {
+			uint32_t col = static_cast<uint32_t>(i % size);
+			return heuristic->EvaluateMove(counters, col, (board.Row(col) + 1) % size);
+		}, minTime));
+	}
+
+	PrintResult("GetThreatsIndicesForPos", "", kind, size, Measure([&](uint64_t i) {
+		return ntf::GetThreatsIndicesForPos(board.Position(static_cast<uint32_t>(i % size)), board).Count();
+	}, minTime));
+
+	if (size <= ntf::MAX_BITBOARD_SIZE) {
+		ntf::Bitboard bitboard(board);
+
+		PrintResult("GetThreatsIndicesForPos (bitboard)", "", kind, size, Measure([&](uint64_t i) {
+			return ntf::GetThreatsIndicesForPos(board.Position(static_cast<uint32_t>(i % size)), bitboard).Count();
+		}, minTime));
+	}
+}
+
+static bool ParseUnsigned(const char* text, uint64_t& value)
+{
+	char* end = nullptr;
+	value = std::strtoull(text, &end, 10);
+	return end != text && *end == '\0' && text[0] != '-';
+}
+
+int main(int argc, char** argv)
+{
+	uint64_t maxSize = MICROBENCH_DEFAULT_MAX_SIZE;
+	uint64_t minTimeMs = MICROBENCH_DEFAULT_MIN_TIME_MS;
+	uint64_t seed = 1;
+
+	for (int i = 1; i < argc; i++) {
+		std::string option = argv[i];
+		uint64_t value = 0;
+
+		if (i + 1 >= argc || !ParseUnsigned(argv[i + 1], value)) {
+			std::fprintf(stderr, "Usage: %s [--max-size <N>] [--min-time-ms <ms>] [--seed <value>]\n", argv[0]);
+			return 1;
+		}
+
+		i++;
+
+		if (option == "--max-size")
+			maxSize = std::max<uint64_t>(value, ntf::MIN_STATIC_BOARD_SIZE);
+		else if (option == "--min-time-ms")
+			minTimeMs = value;
+		else if (option == "--seed")
+			seed = value;
+		else {
+			std::fprintf(stderr, "Unknown option %s\n", option.c_str());
+			return 1;
+		}
+	}
+
+	std::vector<std::shared_ptr<ntf::Heuristic>> heuristics{
+		std::make_shared<ntf::LocalThreats>(),
+		std::make_shared<ntf::GlobalThreats>(),
+	};
+
+	std::mt19937_64 randomEngine(seed);
+	ntf::Microseconds minTime = std::chrono::milliseconds(minTimeMs);
+
+	std::printf("kernel,heuristic,board,size,ns_per_call,calls_per_sec,allocs_per_call\n");
+
+	for (uint64_t size = ntf::MIN_STATIC_BOARD_SIZE; size <= maxSize; size *= 2) {
+		for (BoardKind kind : { BoardKind::RANDOM, BoardKind::SAME_ROW, BoardKind::DIAGONAL })
+			RunKernels(heuristics, kind, static_cast<uint32_t>(size), minTime, randomEngine);
+	}
+
+	return 0;
+}
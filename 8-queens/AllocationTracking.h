@@ -0,0 +1,202 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Builds with NTF_ALLOCATION_TRACKING defined to 1 replace the global operator
+// new and delete to count the allocations of tracked scopes, such as a single
+// solve. The replacement has to be defined in exactly one translation unit, the
+// one that defines NTF_ALLOCATION_TRACKING_IMPLEMENTATION before its includes.
+#ifndef NTF_ALLOCATION_TRACKING
+#define NTF_ALLOCATION_TRACKING 0
+#endif
+
+// Keeps malloc and free out of sight of the inlined operator new and delete,
+// which compilers would otherwise report as mismatched.
+#if defined(_MSC_VER)
+#define NTF_NOINLINE __declspec(noinline)
+#else
+#define NTF_NOINLINE __attribute__((noinline))
+#endif
+
+
+namespace ntf {
+    constexpr bool ALLOCATION_TRACKING_ENABLED = NTF_ALLOCATION_TRACKING != 0;
+
+    struct AllocationStats {
+        uint64_t allocationsCount = 0;
+        uint64_t allocatedBytes = 0;
+        uint64_t peakLiveBytes = 0;
+
+        // Counts and bytes add up, the peak is the highest of the merged ones.
+        AllocationStats& operator += (const AllocationStats& other) {
+            allocationsCount += other.allocationsCount;
+            allocatedBytes += other.allocatedBytes;
+            peakLiveBytes = std::max(peakLiveBytes, other.peakLiveBytes);
+            return *this;
+        }
+    };
+
+    // Allocations of one tracked scope. Live bytes start at zero when the scope is
+    // entered, so the peak is the most memory the scope held on top of what was
+    // already allocated. Threads working for the same scope record concurrently.
+    class AllocationCounters
+    {
+    private:
+        std::atomic<uint64_t> allocationsCount{ 0 };
+        std::atomic<uint64_t> allocatedBytes{ 0 };
+        std::atomic<int64_t> liveBytes{ 0 };
+        std::atomic<int64_t> peakLiveBytes{ 0 };
+
+    public:
+        void RecordAllocation(size_t size)
+        {
+            allocationsCount.fetch_add(1, std::memory_order_relaxed);
+            allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+            int64_t live = liveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+            int64_t peak = peakLiveBytes.load(std::memory_order_relaxed);
+
+            while (peak < live && !peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+        }
+
+        void RecordDeallocation(size_t size)
+        {
+            liveBytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+        }
+
+        AllocationStats Stats() const
+        {
+            return {
+                allocationsCount.load(std::memory_order_relaxed),
+                allocatedBytes.load(std::memory_order_relaxed),
+                static_cast<uint64_t>(peakLiveBytes.load(std::memory_order_relaxed)),
+            };
+        }
+    };
+
+    // Counters the allocations of the current thread are recorded into, if any.
+    inline AllocationCounters*& CurrentAllocationCounters()
+    {
+        static thread_local AllocationCounters* counters = nullptr;
+        return counters;
+    }
+
+    // Records the allocations of the current thread into counters while alive.
+    // Scopes nest, and a null counters pauses the tracking.
+    class AllocationScope
+    {
+    private:
+        AllocationCounters* previous;
+
+    public:
+        explicit AllocationScope(AllocationCounters* counters) : previous(nullptr)
+        {
+            if constexpr (ALLOCATION_TRACKING_ENABLED) {
+                previous = CurrentAllocationCounters();
+                CurrentAllocationCounters() = counters;
+            }
+        }
+
+        ~AllocationScope()
+        {
+            if constexpr (ALLOCATION_TRACKING_ENABLED)
+                CurrentAllocationCounters() = previous;
+        }
+
+        AllocationScope(const AllocationScope&) = delete;
+        AllocationScope& operator = (const AllocationScope&) = delete;
+    };
+
+    // Size of the header in front of every tracked block, which keeps the size
+    // for the unsized delete and the alignment of the block.
+    constexpr size_t ALLOCATION_HEADER_SIZE = alignof(std::max_align_t);
+
+    NTF_NOINLINE inline void* TrackedAllocate(size_t size) noexcept
+    {
+        void* block = std::malloc(size + ALLOCATION_HEADER_SIZE);
+
+        if (block == nullptr)
+            return nullptr;
+
+        *static_cast<size_t*>(block) = size;
+
+        if (AllocationCounters* counters = CurrentAllocationCounters())
+            counters->RecordAllocation(size);
+
+        return static_cast<char*>(block) + ALLOCATION_HEADER_SIZE;
+    }
+
+    NTF_NOINLINE inline void TrackedDeallocate(void* pointer) noexcept
+    {
+        if (pointer == nullptr)
+            return;
+
+        void* block = static_cast<char*>(pointer) - ALLOCATION_HEADER_SIZE;
+
+        if (AllocationCounters* counters = CurrentAllocationCounters())
+            counters->RecordDeallocation(*static_cast<size_t*>(block));
+
+        std::free(block);
+    }
+}
+
+#if NTF_ALLOCATION_TRACKING && defined(NTF_ALLOCATION_TRACKING_IMPLEMENTATION)
+
+void* operator new(std::size_t size)
+{
+    if (void* pointer = ntf::TrackedAllocate(size == 0 ? 1 : size))
+        return pointer;
+
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return ntf::TrackedAllocate(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return ntf::TrackedAllocate(size == 0 ? 1 : size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    ntf::TrackedDeallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    ntf::TrackedDeallocate(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    ntf::TrackedDeallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    ntf::TrackedDeallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    ntf::TrackedDeallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    ntf::TrackedDeallocate(pointer);
+}
+
+#endif
@@ -0,0 +1,157 @@
+#pragma once
+#include "Bits.h"
+#include <array>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace ntf {
+    // Attack tables take size^4 bits, 2 MiB per figure for the largest board.
+    constexpr uint32_t MAX_ATTACK_TABLE_SIZE = 64U;
+
+    // In the order of the figures of the board menu.
+    enum class FigureKind : uint8_t { BISHOP, KING, KNIGHT, PAWN, QUEEN, ROOK };
+
+    constexpr uint32_t FIGURE_KINDS_COUNT = 6U;
+
+    constexpr const char* FIGURE_KIND_NAMES[FIGURE_KINDS_COUNT] = { "bishop", "king", "knight", "pawn", "queen", "rook" };
+
+    inline const char* FigureKindName(FigureKind figure)
+    {
+        return FIGURE_KIND_NAMES[static_cast<uint32_t>(figure)];
+    }
+
+    inline bool ParseFigureKind(const std::string& name, FigureKind& figure)
+    {
+        for (uint32_t i = 0; i < FIGURE_KINDS_COUNT; i++) {
+            if (name == FIGURE_KIND_NAMES[i]) {
+                figure = static_cast<FigureKind>(i);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Whether two figures of the same kind, dx columns and dy rows apart, threaten
+    // each other, that is whether either of them could capture the other. Figures
+    // never share a column, so a zero dx is never a threat. Pawns capture one
+    // square diagonally forward, which makes any diagonal neighbour a threat.
+    constexpr bool FigureThreatens(FigureKind figure, int32_t dx, int32_t dy)
+    {
+        int32_t absDx = dx < 0 ? -dx : dx;
+        int32_t absDy = dy < 0 ? -dy : dy;
+
+        if (absDx == 0)
+            return false;
+
+        switch (figure) {
+        case FigureKind::BISHOP:
+            return absDx == absDy;
+        case FigureKind::KING:
+            return absDx <= 1 && absDy <= 1;
+        case FigureKind::KNIGHT:
+            return (absDx == 1 && absDy == 2) || (absDx == 2 && absDy == 1);
+        case FigureKind::PAWN:
+            return absDx == 1 && absDy == 1;
+        case FigureKind::QUEEN:
+            return absDy == 0 || absDx == absDy;
+        case FigureKind::ROOK:
+            return absDy == 0;
+        }
+
+        return false;
+    }
+
+    // Squares threatened from every square of a board of one size, as bitmasks of
+    // col * size + row bits. Counting the figures threatening a square is then an
+    // AND of its mask with the occupied squares and a popcount, per 64 squares.
+    class AttackTable
+    {
+    private:
+        FigureKind figure;
+        uint32_t size;
+        uint32_t wordsCount;
+        std::vector<uint64_t> masks;
+
+    public:
+        AttackTable(FigureKind figure, uint32_t size)
+            : figure(figure), size(size), wordsCount(WordsCountFor(size * size)), masks(static_cast<size_t>(size) * size * wordsCount, 0)
+        {
+            for (uint32_t col = 0; col < size; col++) {
+                for (uint32_t row = 0; row < size; row++) {
+                    uint64_t* mask = masks.data() + static_cast<size_t>(SquareIndex(col, row)) * wordsCount;
+
+                    for (uint32_t otherCol = 0; otherCol < size; otherCol++) {
+                        for (uint32_t otherRow = 0; otherRow < size; otherRow++) {
+                            int32_t dx = static_cast<int32_t>(otherCol) - static_cast<int32_t>(col);
+                            int32_t dy = static_cast<int32_t>(otherRow) - static_cast<int32_t>(row);
+
+                            if (!FigureThreatens(figure, dx, dy))
+                                continue;
+
+                            uint32_t bit = SquareIndex(otherCol, otherRow);
+                            mask[bit / 64] |= 1ULL << (bit % 64);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Shared table of the figure for the board size, built on first use.
+        // Returns nullptr for boards larger than MAX_ATTACK_TABLE_SIZE.
+        static const AttackTable* Get(FigureKind figure, uint32_t size)
+        {
+            static std::mutex mutex;
+            static std::array<std::array<std::unique_ptr<AttackTable>, MAX_ATTACK_TABLE_SIZE + 1>, FIGURE_KINDS_COUNT> tables;
+
+            if (size > MAX_ATTACK_TABLE_SIZE)
+                return nullptr;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& table = tables[static_cast<uint32_t>(figure)][size];
+
+            if (!table)
+                table = std::make_unique<AttackTable>(figure, size);
+
+            return table.get();
+        }
+
+        FigureKind Figure() const { return figure; }
+
+        uint32_t Size() const { return size; }
+
+        uint32_t WordsCount() const { return wordsCount; }
+
+        uint32_t SquareIndex(uint32_t col, uint32_t row) const
+        {
+            return col * size + row;
+        }
+
+        const uint64_t* Mask(uint32_t col, uint32_t row) const
+        {
+            return masks.data() + static_cast<size_t>(SquareIndex(col, row)) * wordsCount;
+        }
+
+        bool Threatens(uint32_t col, uint32_t row, uint32_t otherCol, uint32_t otherRow) const
+        {
+            uint32_t bit = SquareIndex(otherCol, otherRow);
+            return (Mask(col, row)[bit / 64] >> (bit % 64)) & 1;
+        }
+
+        // Occupied squares threatening the square, given as a mask of wordsCount words.
+        uint32_t CountAttackers(uint32_t col, uint32_t row, const uint64_t* occupancy) const
+        {
+            const uint64_t* mask = Mask(col, row);
+            uint32_t attackers = 0;
+
+            for (uint32_t i = 0; i < wordsCount; i++)
+                attackers += PopCount(mask[i] & occupancy[i]);
+
+            return attackers;
+        }
+    };
+}
@@ -0,0 +1,317 @@
+#pragma once
+#include "Solver.h"
+
+
+namespace ntf {
+	constexpr uint32_t MAX_BACKTRACKING_SIZE = 64U;
+	constexpr uint64_t BACKTRACKING_CLOCK_PERIOD = 4096U;
+
+	// Rows of the next column threatened by the figures placed so far, one bit
+	// per row. Lines move by one row per column, so after every placement the
+	// diagonals are shifted to stay aligned with the next column.
+	struct BacktrackingState {
+		uint64_t rows = 0;
+		uint64_t diagonals = 0;
+		uint64_t antiDiagonals = 0;
+		uint64_t previousRow = 0;
+		uint64_t beforePreviousRow = 0;
+
+		template<FigureKind F>
+		uint64_t FreeRows(uint64_t boardMask) const {
+			uint64_t threatened = 0;
+
+			if constexpr (F == FigureKind::QUEEN)
+				threatened = rows | diagonals | antiDiagonals;
+			else if constexpr (F == FigureKind::ROOK)
+				threatened = rows;
+			else if constexpr (F == FigureKind::BISHOP)
+				threatened = diagonals | antiDiagonals;
+			else if constexpr (F == FigureKind::KING)
+				threatened = previousRow | Aside(previousRow, 1);
+			else if constexpr (F == FigureKind::PAWN)
+				threatened = Aside(previousRow, 1);
+			else
+				threatened = Aside(previousRow, 2) | Aside(beforePreviousRow, 1);
+
+			return ~threatened & boardMask;
+		}
+
+		BacktrackingState Place(uint64_t rowBit, uint64_t boardMask) const {
+			return {
+				rows | rowBit,
+				((diagonals | rowBit) << 1) & boardMask,
+				(antiDiagonals | rowBit) >> 1,
+				rowBit,
+				previousRow,
+			};
+		}
+
+		static uint64_t Aside(uint64_t bits, uint32_t distance) {
+			return (bits << distance) | (bits >> distance);
+		}
+	};
+
+	struct SolutionsCount {
+		uint64_t solutionsCount = 0;
+		uint64_t nodesCount = 0;
+		Microseconds duration = std::chrono::microseconds::zero();
+		bool timedOut = false;
+	};
+
+	// Depth first walk over the columns of one search, which counts the visited
+	// nodes and polls the context every BACKTRACKING_CLOCK_PERIOD of them.
+	class BacktrackingWalk
+	{
+	private:
+		const SolveContext& context;
+
+	public:
+		uint32_t size;
+		uint64_t boardMask;
+		uint64_t nodesCount = 0;
+		bool stopped = false;
+		SolverStatsCounter stats;
+
+		BacktrackingWalk(uint32_t size, const SolveContext& context)
+			: context(context), size(size), boardMask(size >= 64 ? UINT64_MAX : (1ULL << size) - 1)
+		{}
+
+		// Returns false once the context stops the walk.
+		bool Visit() {
+			stats.CountIteration();
+
+			if (++nodesCount % BACKTRACKING_CLOCK_PERIOD == 0) {
+				context.ReportProgress(nodesCount, UINT32_MAX);
+				stopped = context.ShouldStop(nodesCount);
+			}
+
+			return !stopped;
+		}
+
+		// Boards completing the state from the column on.
+		template<FigureKind F>
+		uint64_t CountCompletions(const BacktrackingState& state, uint32_t col) {
+			if (col == size)
+				return 1;
+
+			uint64_t freeRows = state.FreeRows<F>(boardMask);
+			uint64_t count = 0;
+
+			// Every free row of the last column completes a board.
+			if (col + 1 == size) {
+				nodesCount += PopCount(freeRows);
+				return PopCount(freeRows);
+			}
+
+			while (freeRows != 0 && Visit()) {
+				uint64_t rowBit = freeRows & (0 - freeRows);
+				freeRows ^= rowBit;
+
+				count += CountCompletions<F>(state.Place(rowBit, boardMask), col + 1);
+			}
+
+			return count;
+		}
+
+		// Calls the callback with every board completing the state from the column
+		// on, in lexicographic order of the rows.
+		template<FigureKind F, typename Callback>
+		void EnumerateCompletions(const BacktrackingState& state, uint32_t col, Board& positions, Callback& callback) {
+			if (col == size) {
+				callback(static_cast<const Board&>(positions));
+				return;
+			}
+
+			uint64_t freeRows = state.FreeRows<F>(boardMask);
+
+			while (freeRows != 0 && Visit()) {
+				uint64_t rowBit = freeRows & (0 - freeRows);
+				freeRows ^= rowBit;
+
+				positions.SetRow(col, CountTrailingZeros(rowBit));
+				EnumerateCompletions<F>(state.Place(rowBit, boardMask), col + 1, positions, callback);
+			}
+		}
+
+		// Completes the state from the column on into positions, trying the rows
+		// of every column by their distance to its row on the initial board.
+		template<FigureKind F>
+		bool FindCompletion(const BacktrackingState& state, uint32_t col, const Board& initialPositions, Board& positions) {
+			if (col == size)
+				return true;
+
+			uint64_t freeRows = state.FreeRows<F>(boardMask);
+			uint32_t initialRow = initialPositions.Row(col);
+
+			for (uint32_t distance = 0; freeRows != 0 && distance < size; distance++) {
+				uint32_t candidates[2] = { initialRow + distance, initialRow - distance };
+
+				for (uint32_t i = 0; i < (distance == 0 ? 1U : 2U); i++) {
+					uint32_t row = candidates[i];
+
+					if (row >= size || (freeRows >> row & 1) == 0)
+						continue;
+
+					uint64_t rowBit = 1ULL << row;
+					freeRows ^= rowBit;
+
+					if (!Visit())
+						return false;
+
+					positions.SetRow(col, row);
+
+					if (FindCompletion<F>(state.Place(rowBit, boardMask), col + 1, initialPositions, positions))
+						return true;
+
+					if (stopped)
+						return false;
+				}
+			}
+
+			return false;
+		}
+	};
+
+	// Complete search over boards up to 64 x 64 with the rows, diagonals and
+	// anti-diagonals taken so far kept as bitmasks. It finds a solution whenever
+	// one exists, unless the context stops it first, and starts from the rows of
+	// the initial board, so the solution tends to stay close to it. The heuristic
+	// and the param are not used by this algorithm. The bitmasks hold one bit per
+	// row, so larger boards are returned unsolved without a search; callers can
+	// check MaxBoardSize first.
+	class Backtracking : public Solver
+	{
+	public:
+		using Solver::Solve;
+
+		Backtracking() : Solver("Backtracking", SolverParam{}) {}
+
+		template<FigureKind F>
+		using FigureTag = std::integral_constant<FigureKind, F>;
+
+		// Calls the callback with FigureTag<F> of the figure, so the walk is
+		// specialised for its threats.
+		template<typename Callback>
+		static auto DispatchFigure(FigureKind figure, Callback&& callback)
+		{
+			switch (figure) {
+			case FigureKind::BISHOP:
+				return callback(FigureTag<FigureKind::BISHOP>{});
+			case FigureKind::KING:
+				return callback(FigureTag<FigureKind::KING>{});
+			case FigureKind::KNIGHT:
+				return callback(FigureTag<FigureKind::KNIGHT>{});
+			case FigureKind::PAWN:
+				return callback(FigureTag<FigureKind::PAWN>{});
+			case FigureKind::ROOK:
+				return callback(FigureTag<FigureKind::ROOK>{});
+			default:
+				return callback(FigureTag<FigureKind::QUEEN>{});
+			}
+		}
+
+		uint32_t MaxBoardSize() const override { return MAX_BACKTRACKING_SIZE; }
+
+		Solution Solve(
+			const Board& figuresPositions,
+			const SolverParam& /*param*/,
+			const std::shared_ptr<Heuristic> /*heuristic*/,
+			const SolveContext& context
+		) override
+		{
+			auto startTime = HighResClock::now();
+			const uint32_t size = figuresPositions.Size();
+
+			if (size == 0 || size > MAX_BACKTRACKING_SIZE)
+				return Unsolved(startTime, 0);
+
+			TraceSpan searchSpan("Backtracking search");
+
+			BacktrackingWalk walk(size, context);
+			Board positions(figuresPositions);
+
+			bool found = DispatchFigure(context.figure, [&](auto figure) {
+				return walk.FindCompletion<decltype(figure)::value>(BacktrackingState{}, 0, figuresPositions, positions);
+			});
+
+			Solution solution{};
+
+			if (walk.stopped)
+				solution = TimedOut(figuresPositions, startTime, walk.nodesCount);
+			else if (!found)
+				solution = Unsolved(startTime, walk.nodesCount);
+			else
+				solution = Solved(std::move(positions), startTime, walk.nodesCount);
+
+			solution.stats = walk.stats.Stats();
+			return solution;
+		}
+
+		// Counts all solutions of a board of the given size for the figure of the
+		// context. Mirroring a solution upside down gives another one, so only
+		// the upper half of the first column is searched and counted twice, plus
+		// the middle row of odd boards.
+		static SolutionsCount CountSolutions(uint32_t size, const SolveContext& context)
+		{
+			auto startTime = HighResClock::now();
+			SolutionsCount result{};
+
+			if (size == 0 || size > MAX_BACKTRACKING_SIZE)
+				return result;
+
+			TraceSpan countSpan("Backtracking count");
+
+			BacktrackingWalk walk(size, context);
+
+			result.solutionsCount = DispatchFigure(context.figure, [&](auto figure) {
+				uint64_t count = 0;
+
+				for (uint32_t row = 0; row < (size + 1) / 2 && walk.Visit(); row++) {
+					uint64_t rowBit = 1ULL << row;
+					uint64_t completions = walk.CountCompletions<decltype(figure)::value>(BacktrackingState{}.Place(rowBit, walk.boardMask), 1);
+
+					count += row * 2 + 1 == size ? completions : completions * 2;
+				}
+
+				return count;
+			});
+
+			result.nodesCount = walk.nodesCount;
+			result.duration = TakeTimeStamp(startTime);
+			result.timedOut = walk.stopped;
+			return result;
+		}
+
+		// Calls the callback with every solution of a board of the given size for
+		// the figure of the context, in lexicographic order. The mirror symmetry
+		// would break the order, so the whole tree is walked.
+		template<typename Callback>
+		static SolutionsCount EnumerateSolutions(uint32_t size, const SolveContext& context, Callback&& callback)
+		{
+			auto startTime = HighResClock::now();
+			SolutionsCount result{};
+
+			if (size == 0 || size > MAX_BACKTRACKING_SIZE)
+				return result;
+
+			TraceSpan enumerateSpan("Backtracking enumeration");
+
+			BacktrackingWalk walk(size, context);
+			Board positions(size);
+
+			auto countingCallback = [&](const Board& solution) {
+				result.solutionsCount++;
+				callback(solution);
+			};
+
+			DispatchFigure(context.figure, [&](auto figure) {
+				walk.EnumerateCompletions<decltype(figure)::value>(BacktrackingState{}, 0, positions, countingCallback);
+			});
+
+			result.nodesCount = walk.nodesCount;
+			result.duration = TakeTimeStamp(startTime);
+			result.timedOut = walk.stopped;
+			return result;
+		}
+	};
+}
@@ -1,110 +1,268 @@
 #pragma once
 #include "Solver.h"
+#include "HashSet.h"
+#include "TopK.h"
+#include "ThreadPool.h"
 #include <random>
 
 
 namespace ntf {
+	constexpr uint64_t BEAM_PARALLEL_MIN_CANDIDATES = 4096U;
+
+	// Successor of a beam state, kept unmaterialised until it makes it into the next beam.
+	struct BeamCandidate {
+		uint32_t heuristicValue;
+		uint32_t parentIndex;
+		uint32_t col;
+		uint32_t row;
+		uint64_t hash;
+
+		bool operator < (const BeamCandidate& other) const {
+			if (heuristicValue != other.heuristicValue)
+				return heuristicValue < other.heuristicValue;
+			if (parentIndex != other.parentIndex)
+				return parentIndex < other.parentIndex;
+			if (col != other.col)
+				return col < other.col;
+			return row < other.row;
+		}
+	};
+
+	// Counters and selection owned by one chunk of the beam during expansion.
+	template<uint32_t N>
+	struct BeamWorker {
+		BasicThreatCounters<N> counters;
+		TopK<BeamCandidate> selection;
+		uint64_t generatedStatesCount = 0;
+		SolverStatsCounter stats;
+	};
+
 	class BeamSearch : public Solver
 	{
+	private:
+		std::shared_ptr<ThreadPool> threadPool;
+
 	public:
-		BeamSearch(const SolverParam& param) : Solver("Beam Search", param) {}
+		using Solver::Solve;
+
+		// Large generations are expanded on the given pool, whose idle workers
+		// join in. Inside bulk tests, which keep every worker busy, solves stay
+		// on their own thread.
+		BeamSearch(const SolverParam& param, std::shared_ptr<ThreadPool> threadPool = ThreadPool::Shared())
+			: Solver("Beam Search", param), threadPool(std::move(threadPool))
+		{}
 
 		Solution Solve(
-			const std::vector<olc::vi2d>& figuresPositions,
+			const Board& figuresPositions,
 			const SolverParam& param,
-			const std::shared_ptr<Heuristic> heuristic
+			const std::shared_ptr<Heuristic> heuristic,
+			const SolveContext& context
 		) override
 		{
+			SolverStatsCounter stats;
+
+			Solution solution = DispatchBoardSize(figuresPositions.Size(), [&](auto size) {
+				return SolveSized<decltype(size)::value>(figuresPositions, param, heuristic, context, stats);
+			});
+
+			solution.stats = stats.Stats();
+			return solution;
+		}
+
+		template<uint32_t N>
+		Solution SolveSized(
+			const Board& figuresPositions,
+			const SolverParam& param,
+			const std::shared_ptr<Heuristic> heuristic,
+			const SolveContext& context,
+			SolverStatsCounter& stats
+		) {
 			auto startTime = HighResClock::now();
-			int generatedStatesCount = 0;
-
-			if (heuristic->EvaluateBoard(figuresPositions) == 0) {
-				return {
-					figuresPositions,
-					TakeTimeStamp(startTime),
-					generatedStatesCount,
-				};
+			uint64_t generatedStatesCount = 0;
+
+			SearchState bestFit(figuresPositions, heuristic->EvaluateBoard(figuresPositions, context.figure));
+			stats.CountHeuristicEvaluations();
+
+			if (bestFit.heuristicValue == 0) {
+				return Solved(figuresPositions, startTime, generatedStatesCount);
 			}
 
-			std::default_random_engine randomEngine;
-			randomEngine.seed(static_cast<uint32_t>(HighResClock::now().time_since_epoch().count()));
+			std::mt19937_64 randomEngine(context.seed);
 
 			const int beamWidth = param.value;
+			const uint32_t size = figuresPositions.Size();
+
+			std::uniform_int_distribution<int> distribution(0, static_cast<int>(size - 1));
+
+			BasicThreatCounters<N> counters(figuresPositions, context.figure);
+			uint64_t initialHash = ZobristHash(figuresPositions);
+
+			std::vector<SearchState> beam{};
+			std::vector<BeamCandidate> selected{};
+			TopK<BeamCandidate> selection(beamWidth);
+			HashSet visitedStates{};
+
+			std::vector<BeamWorker<N>> workers(threadPool->ThreadsCount());
 
-			std::uniform_int_distribution<int> distribution(0, static_cast<int>(figuresPositions.size() - 1));
+			for (auto& worker : workers)
+				worker.counters = BasicThreatCounters<N>(context.figure);
 
-			SearchStatesQueue queue;
-			
-			std::shared_ptr<SearchState> currentState(std::make_shared<SearchState>());
-			std::unordered_map<std::string, bool> visitedStates{};
+			// A board has N * (N - 1) neighbours plus itself, so a wider beam could never be filled.
+			const int initialStatesCount = std::min(beamWidth, static_cast<int>(size * (size - 1) + 1));
 
-			for (int i = 0; i < beamWidth;) {
+			for (int i = 0; i < initialStatesCount;) {
 
 				int randomCol = distribution(randomEngine);
 				int randomRow = distribution(randomEngine);
 
-				*currentState = std::move(GenerateState(figuresPositions, { randomCol, randomRow }, heuristic));
-				std::string stateKey = std::move(currentState->Serialize());
+				SearchState state = GenerateState(counters, initialHash, { randomCol, randomRow }, heuristic);
+				stats.CountHeuristicEvaluations();
 
-				if (visitedStates.find(stateKey) != visitedStates.end())
+				bool visited = visitedStates.Contains(state.hash);
+				stats.CountVisitedLookup(visited);
+
+				if (visited)
 					continue;
 				
 				generatedStatesCount++;
 				i++;
 
-				if (currentState->heuristicValue == 0) {
-					return {
-						currentState->figuresPositions,
-						TakeTimeStamp(startTime),
-						generatedStatesCount,
-					};
+				if (state.heuristicValue == 0) {
+					return Solved(std::move(state.figuresPositions), startTime, generatedStatesCount);
 				}
 
-				queue.push(std::move(*currentState));
-				visitedStates.insert({ stateKey, true });
+				visitedStates.Insert(state.hash);
+
+				if (state < bestFit)
+					bestFit = state;
+
+				beam.push_back(std::move(state));
 			}
 
-			while (!queue.empty()) {
+			for (uint64_t generation = 0; !beam.empty(); generation++) {
+				TraceSpan generationSpan("Beam generation");
 
-				SearchStatesQueue subQueue;
+				context.ReportProgress(generation, bestFit.heuristicValue);
 
-				while (!queue.empty()) {
-					*currentState = queue.top();
-					queue.pop();
+				if (context.ShouldStop(generation))
+					return TimedOut(std::move(bestFit.figuresPositions), startTime, generatedStatesCount);
 
-					if (currentState->heuristicValue == 0) {
-						return {
-							currentState->figuresPositions,
-							TakeTimeStamp(startTime),
-							generatedStatesCount,
-						};
-					}
+				stats.CountIteration();
+				stats.CountFrontierSize(beam.size());
+
+				// Small generations are not worth waking up the pool for.
+				uint64_t candidatesCount = static_cast<uint64_t>(beam.size()) * size * size;
+				size_t chunksCount = candidatesCount < BEAM_PARALLEL_MIN_CANDIDATES
+					? 1 : std::min(workers.size(), beam.size());
+
+				// Parents are split into contiguous ranges and every chunk keeps its own
+				// top-k. The candidates order is total, so merging the chunks gives the
+				// same selection as a serial expansion, whatever the threads count.
+				threadPool->ParallelFor(chunksCount, [&](size_t chunk) {
+					TraceSpan expansionSpan("Beam expansion");
 
-					for (auto& position : currentState->figuresPositions) {
+					uint32_t begin = static_cast<uint32_t>(chunk * beam.size() / chunksCount);
+					uint32_t end = static_cast<uint32_t>((chunk + 1) * beam.size() / chunksCount);
 
-						for (auto& result : heuristic->EvaluateColumn(position, currentState->figuresPositions)) {
-							subQueue.push(std::move(GenerateState(currentState->figuresPositions, result.position, heuristic)));
-							generatedStatesCount++;
-						}
+					workers[chunk].selection.Reset(beamWidth);
+					ExpandBeam(beam, begin, end, visitedStates, heuristic, workers[chunk]);
+				});
+
+				TraceSpan selectionSpan("Beam selection");
+
+				for (size_t chunk = 0; chunk < chunksCount; chunk++) {
+					workers[chunk].selection.SortInto(selected);
+					generatedStatesCount += workers[chunk].generatedStatesCount;
+					workers[chunk].generatedStatesCount = 0;
+
+					stats.Merge(workers[chunk].stats);
+					workers[chunk].stats = {};
+
+					for (auto& candidate : selected) {
+						if (!selection.Push(candidate))
+							break;
 					}
 				}
 
-				for (int i = 0; i < beamWidth && !subQueue.empty(); i++) {
+				selection.SortInto(selected);
+				stats.CountQueuePops(selected.size());
 
-					*currentState = subQueue.top();
-					subQueue.pop();
+				std::vector<SearchState> nextBeam{};
+				nextBeam.reserve(selected.size());
 
-					std::string stateKey = std::move(currentState->Serialize());
+				for (auto& candidate : selected) {
 
-					if (visitedStates.find(stateKey) != visitedStates.end())
+					// The same board can be reached from two parents of a generation.
+					bool inserted = visitedStates.Insert(candidate.hash);
+					stats.CountVisitedLookup(!inserted);
+
+					if (!inserted) {
+						stats.CountDuplicate();
 						continue;
+					}
+
+					Board positions(beam[candidate.parentIndex].figuresPositions);
+					positions.SetRow(candidate.col, candidate.row);
 
-					queue.push(std::move(*currentState));
-					visitedStates.insert({ stateKey, true });
+					if (candidate.heuristicValue == 0) {
+						return Solved(std::move(positions), startTime, generatedStatesCount);
+					}
+
+					nextBeam.emplace_back(std::move(positions), candidate.heuristicValue, candidate.hash);
 				}
+
+				// The next beam is sorted, so its first state is the best of the generation.
+				if (!nextBeam.empty() && nextBeam.front() < bestFit)
+					bestFit = nextBeam.front();
+
+				beam = std::move(nextBeam);
 			}
 
-			return { {}, TakeTimeStamp(startTime), generatedStatesCount };
+			return Unsolved(startTime, generatedStatesCount);
+		}
+
+	private:
+		// Pushes successors of beam[begin, end) that were not visited yet into the worker's selection.
+		template<uint32_t N>
+		static void ExpandBeam(
+			const std::vector<SearchState>& beam,
+			uint32_t begin,
+			uint32_t end,
+			const HashSet& visitedStates,
+			const std::shared_ptr<Heuristic>& heuristic,
+			BeamWorker<N>& worker
+		) {
+			auto& counters = worker.counters;
+
+			for (uint32_t parentIndex = begin; parentIndex < end; parentIndex++) {
+				const SearchState& parent = beam[parentIndex];
+
+				counters.Reset(parent.figuresPositions);
+
+				for (uint32_t col = 0; col < counters.Size(); col++) {
+					uint32_t currentRow = parent.figuresPositions.Row(col);
+
+					for (uint32_t row = 0; row < counters.Size(); row++) {
+						BeamCandidate candidate{ heuristic->EvaluateMove(counters, col, row), parentIndex, col, row, 0 };
+						worker.generatedStatesCount++;
+						worker.stats.CountHeuristicEvaluations();
+
+						if (!worker.selection.Accepts(candidate))
+							continue;
+
+						candidate.hash = ZobristMove(parent.hash, col, currentRow, row);
+
+						bool visited = visitedStates.Contains(candidate.hash);
+						worker.stats.CountVisitedLookup(visited);
+
+						if (visited)
+							continue;
+
+						worker.selection.Push(candidate);
+						worker.stats.CountQueuePushes();
+					}
+				}
+			}
 		}
 	};
 }
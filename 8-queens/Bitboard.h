@@ -0,0 +1,234 @@
+#pragma once
+#include "AttackTable.h"
+#include "Board.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+
+
+namespace ntf {
+    constexpr uint32_t MAX_BITBOARD_SIZE = 64U;
+
+    // Set of column indices of a board. Boards up to 64 columns keep it in a
+    // single inline word, larger ones on the heap. Iterating yields the indices
+    // in increasing order.
+    class ColumnSet
+    {
+    private:
+        uint32_t size;
+        uint64_t inlineWord;
+        std::vector<uint64_t> heapWords;
+
+    public:
+        class Iterator
+        {
+        private:
+            const uint64_t* words;
+            uint32_t wordsCount;
+            uint32_t wordIndex;
+            uint64_t bits;
+
+            void SkipEmptyWords()
+            {
+                while (bits == 0 && wordIndex < wordsCount && ++wordIndex < wordsCount)
+                    bits = words[wordIndex];
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = uint32_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const uint32_t*;
+            using reference = uint32_t;
+
+            Iterator(const uint64_t* words, uint32_t wordsCount, uint32_t wordIndex)
+                : words(words), wordsCount(wordsCount), wordIndex(wordIndex), bits(wordIndex < wordsCount ? words[wordIndex] : 0)
+            {
+                SkipEmptyWords();
+            }
+
+            uint32_t operator * () const
+            {
+                return wordIndex * 64 + CountTrailingZeros(bits);
+            }
+
+            Iterator& operator ++ ()
+            {
+                bits &= bits - 1;
+                SkipEmptyWords();
+                return *this;
+            }
+
+            Iterator operator ++ (int)
+            {
+                Iterator previous(*this);
+                ++*this;
+                return previous;
+            }
+
+            bool operator == (const Iterator& other) const { return wordIndex == other.wordIndex && bits == other.bits; }
+
+            bool operator != (const Iterator& other) const { return !(*this == other); }
+        };
+
+        explicit ColumnSet(uint32_t size = 0) : size(size), inlineWord(0), heapWords{}
+        {
+            if (size > MAX_BITBOARD_SIZE)
+                heapWords.assign(WordsCountFor(size), 0);
+        }
+
+        // Set of the columns of the given bits, for boards up to 64 columns.
+        ColumnSet(uint32_t size, uint64_t bits) : ColumnSet(size)
+        {
+            inlineWord = bits;
+        }
+
+        uint32_t Size() const { return size; }
+
+        uint32_t WordsCount() const
+        {
+            return size > MAX_BITBOARD_SIZE ? static_cast<uint32_t>(heapWords.size()) : 1;
+        }
+
+        const uint64_t* Words() const
+        {
+            return size > MAX_BITBOARD_SIZE ? heapWords.data() : &inlineWord;
+        }
+
+        void Insert(uint32_t col)
+        {
+            uint64_t* words = size > MAX_BITBOARD_SIZE ? heapWords.data() : &inlineWord;
+            words[col / 64] |= 1ULL << (col % 64);
+        }
+
+        bool Contains(uint32_t col) const
+        {
+            return (Words()[col / 64] >> (col % 64)) & 1;
+        }
+
+        uint32_t Count() const
+        {
+            uint32_t count = 0;
+
+            for (uint32_t i = 0; i < WordsCount(); i++)
+                count += PopCount(Words()[i]);
+
+            return count;
+        }
+
+        bool Empty() const
+        {
+            return Count() == 0;
+        }
+
+        Iterator begin() const { return Iterator(Words(), WordsCount(), 0); }
+
+        Iterator end() const { return Iterator(Words(), WordsCount(), WordsCount()); }
+    };
+
+    // Board of up to 64 x 64 squares as one word per row, whose bits are the
+    // columns holding a figure on that row. The attackers of a square are found
+    // row by row, masking the row with the square's column bit shifted by the
+    // column offsets the figure attacks from there. Figures with a short reach
+    // only look at the rows they reach, the others at every row. Callers owning
+    // a board keep its bitboard in step with the moves instead of rebuilding it.
+    class Bitboard
+    {
+    private:
+        uint32_t size;
+        std::array<uint64_t, MAX_BITBOARD_SIZE> rows;
+
+    public:
+        explicit Bitboard(uint32_t size = 0) : size(size), rows{} {}
+
+        explicit Bitboard(const Board& figuresPositions) : Bitboard(figuresPositions.Size())
+        {
+            for (uint32_t col = 0; col < size; col++)
+                Place(col, figuresPositions.Row(col));
+        }
+
+        uint32_t Size() const { return size; }
+
+        void Place(uint32_t col, uint32_t row)
+        {
+            rows[row] |= 1ULL << col;
+        }
+
+        void Remove(uint32_t col, uint32_t row)
+        {
+            rows[row] &= ~(1ULL << col);
+        }
+
+        void Move(uint32_t col, uint32_t fromRow, uint32_t toRow)
+        {
+            Remove(col, fromRow);
+            Place(col, toRow);
+        }
+
+        // Columns whose figure threatens the square, the square's own column excluded.
+        uint64_t AttackersOf(uint32_t col, uint32_t row, FigureKind figure) const
+        {
+            uint32_t reach = Reach(figure);
+            uint32_t firstRow = row > reach ? row - reach : 0;
+            uint32_t lastRow = std::min(row + reach, size - 1);
+
+            uint64_t attackers = 0;
+
+            for (uint32_t otherRow = firstRow; otherRow <= lastRow; otherRow++) {
+                uint32_t distance = otherRow > row ? otherRow - row : row - otherRow;
+                attackers |= rows[otherRow] & AttackedColumns(figure, col, distance);
+            }
+
+            return attackers & ~(1ULL << col);
+        }
+
+    private:
+        uint64_t ColumnsMask() const
+        {
+            return size == 64 ? UINT64_MAX : (1ULL << size) - 1;
+        }
+
+        static uint32_t Reach(FigureKind figure)
+        {
+            switch (figure) {
+            case FigureKind::KING:
+            case FigureKind::PAWN:
+                return 1;
+            case FigureKind::KNIGHT:
+                return 2;
+            case FigureKind::ROOK:
+                return 0;
+            default:
+                return MAX_BITBOARD_SIZE;
+            }
+        }
+
+        // Columns attacked from the column on the rows the given distance away.
+        uint64_t AttackedColumns(FigureKind figure, uint32_t col, uint32_t distance) const
+        {
+            uint64_t column = 1ULL << col;
+
+            auto aside = [&](uint32_t offset) {
+                return offset < 64 ? (column << offset) | (column >> offset) : 0;
+            };
+
+            switch (figure) {
+            case FigureKind::BISHOP:
+                return distance == 0 ? 0 : aside(distance);
+            case FigureKind::KING:
+                return aside(1);
+            case FigureKind::KNIGHT:
+                return distance == 1 ? aside(2) : distance == 2 ? aside(1) : 0;
+            case FigureKind::PAWN:
+                return distance == 1 ? aside(1) : 0;
+            case FigureKind::QUEEN:
+                return distance == 0 ? ColumnsMask() : aside(distance);
+            case FigureKind::ROOK:
+                return distance == 0 ? ColumnsMask() : 0;
+            }
+
+            return 0;
+        }
+    };
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+namespace ntf {
+
+    // MSVC emits the POPCNT instruction unchecked, so it is only used where the
+    // target guarantees it (x64 with /arch:AVX or later, and ARM64).
+    inline uint32_t PopCount(uint64_t bits)
+    {
+#if defined(_MSC_VER) && defined(_M_X64) && defined(__AVX__)
+        return static_cast<uint32_t>(__popcnt64(bits));
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+        return static_cast<uint32_t>(_CountOneBits64(bits));
+#elif defined(_MSC_VER)
+        bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+        bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+        bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return static_cast<uint32_t>((bits * 0x0101010101010101ULL) >> 56);
+#else
+        return static_cast<uint32_t>(__builtin_popcountll(bits));
+#endif
+    }
+
+    // Index of the lowest set bit, bits must not be zero.
+    inline uint32_t CountTrailingZeros(uint64_t bits)
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return static_cast<uint32_t>(index);
+#elif defined(_MSC_VER)
+        unsigned long index;
+
+        if (_BitScanForward(&index, static_cast<unsigned long>(bits)))
+            return static_cast<uint32_t>(index);
+
+        _BitScanForward(&index, static_cast<unsigned long>(bits >> 32));
+        return static_cast<uint32_t>(index) + 32;
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(bits));
+#endif
+    }
+
+    constexpr uint32_t WordsCountFor(uint32_t bitsCount)
+    {
+        return (bitsCount + 63) / 64;
+    }
+}
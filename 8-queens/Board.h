@@ -0,0 +1,187 @@
+#pragma once
+#include "Square.h"
+#include <cstring>
+#include <vector>
+
+
+namespace ntf {
+    constexpr uint32_t BOARD_INLINE_CAPACITY = 32U;
+
+    // One row index per column. Rows are stored as uint8_t while they fit and are
+    // widened to 16 or 32 bits for larger boards. Small boards live inline, so
+    // copying one is a fixed size memcpy without heap allocation.
+    class Board
+    {
+    private:
+        uint32_t size;
+        uint8_t rowWidth;
+
+        union {
+            uint8_t inlineRows[BOARD_INLINE_CAPACITY];
+            uint8_t* heapRows;
+        };
+
+    public:
+        Board() : size(0), rowWidth(1), inlineRows{} {}
+
+        explicit Board(uint32_t size) : size(size), rowWidth(RowWidthFor(size)), inlineRows{}
+        {
+            if (!IsInline())
+                heapRows = new uint8_t[BytesCount()]();
+        }
+
+        Board(const std::vector<Square>& positions) : Board(static_cast<uint32_t>(positions.size()))
+        {
+            for (auto& position : positions)
+                SetRow(position.x, position.y);
+        }
+
+        Board(const Board& other) : size(other.size), rowWidth(other.rowWidth), inlineRows{}
+        {
+            if (other.IsInline())
+                std::memcpy(inlineRows, other.inlineRows, BOARD_INLINE_CAPACITY);
+            else {
+                heapRows = new uint8_t[BytesCount()];
+                std::memcpy(heapRows, other.heapRows, BytesCount());
+            }
+        }
+
+        Board(Board&& other) noexcept : size(other.size), rowWidth(other.rowWidth), inlineRows{}
+        {
+            std::memcpy(inlineRows, other.inlineRows, BOARD_INLINE_CAPACITY);
+            other.size = 0;
+            other.rowWidth = 1;
+        }
+
+        ~Board()
+        {
+            if (!IsInline())
+                delete[] heapRows;
+        }
+
+        Board& operator = (const Board& other)
+        {
+            if (this != &other) {
+                Board copy(other);
+                Swap(copy);
+            }
+            return *this;
+        }
+
+        Board& operator = (Board&& other) noexcept
+        {
+            if (this != &other) {
+                Board moved(std::move(other));
+                Swap(moved);
+            }
+            return *this;
+        }
+
+        bool operator == (const Board& other) const
+        {
+            return size == other.size && std::memcmp(Data(), other.Data(), BytesCount()) == 0;
+        }
+
+        bool operator != (const Board& other) const
+        {
+            return !(*this == other);
+        }
+
+        bool operator < (const Board& other) const
+        {
+            if (size != other.size)
+                return size < other.size;
+
+            for (uint32_t i = 0; i < size; i++) {
+                if (Row(i) != other.Row(i))
+                    return Row(i) < other.Row(i);
+            }
+
+            return false;
+        }
+
+        uint32_t Size() const { return size; }
+
+        bool Empty() const { return size == 0; }
+
+        uint32_t Row(uint32_t col) const
+        {
+            const uint8_t* data = Data();
+
+            if (rowWidth == 1)
+                return data[col];
+
+            if (rowWidth == 2) {
+                uint16_t row;
+                std::memcpy(&row, data + col * 2, sizeof(row));
+                return row;
+            }
+
+            uint32_t row;
+            std::memcpy(&row, data + col * 4, sizeof(row));
+            return row;
+        }
+
+        void SetRow(uint32_t col, uint32_t row)
+        {
+            uint8_t* data = Data();
+
+            if (rowWidth == 1)
+                data[col] = static_cast<uint8_t>(row);
+
+            else if (rowWidth == 2) {
+                uint16_t value = static_cast<uint16_t>(row);
+                std::memcpy(data + col * 2, &value, sizeof(value));
+            }
+
+            else
+                std::memcpy(data + col * 4, &row, sizeof(row));
+        }
+
+        Square Position(uint32_t col) const
+        {
+            return { static_cast<int>(col), static_cast<int>(Row(col)) };
+        }
+
+        std::vector<Square> ToPositions() const
+        {
+            std::vector<Square> positions{};
+            positions.reserve(size);
+
+            for (uint32_t i = 0; i < size; i++)
+                positions.push_back(Position(i));
+
+            return positions;
+        }
+
+        void Swap(Board& other) noexcept
+        {
+            uint8_t buffer[BOARD_INLINE_CAPACITY];
+
+            std::memcpy(buffer, inlineRows, BOARD_INLINE_CAPACITY);
+            std::memcpy(inlineRows, other.inlineRows, BOARD_INLINE_CAPACITY);
+            std::memcpy(other.inlineRows, buffer, BOARD_INLINE_CAPACITY);
+
+            std::swap(size, other.size);
+            std::swap(rowWidth, other.rowWidth);
+        }
+
+        static uint8_t RowWidthFor(uint32_t size)
+        {
+            if (size <= UINT8_MAX + 1U)
+                return 1;
+            if (size <= UINT16_MAX + 1U)
+                return 2;
+            return 4;
+        }
+
+    private:
+        size_t BytesCount() const { return static_cast<size_t>(size) * rowWidth; }
+
+        bool IsInline() const { return BytesCount() <= BOARD_INLINE_CAPACITY; }
+
+        const uint8_t* Data() const { return IsInline() ? inlineRows : heapRows; }
+
+        uint8_t* Data() { return IsInline() ? inlineRows : heapRows; }
+    };
+}
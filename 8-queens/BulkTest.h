@@ -0,0 +1,229 @@
+#pragma once
+#include "Solver.h"
+#include "ThreadPool.h"
+#include "Random.h"
+#include "Histogram.h"
+#include <future>
+#include <mutex>
+#include <random>
+
+
+namespace ntf {
+    constexpr uint32_t BULK_TESTS_PUBLISH_PERIOD = 16U;
+
+    struct BulkTestInfo {
+        uint64_t totalDuration = 0;
+        uint64_t totalStatesGenerated = 0;
+        uint64_t totalMoves = 0;
+        uint32_t currentIteration = 0;
+        uint32_t passedIterations = 0;
+        uint32_t failedIterations = 0;
+
+        // Order independent digest of the solved boards and their iterations. The
+        // same seed gives the same checksum whatever the amount of threads.
+        uint64_t solutionsChecksum = 0;
+
+        // Summed over passed and failed runs.
+        SolverStats stats;
+        AllocationStats allocations;
+
+        // Distributions of the passed solves and the time spent on the failed ones.
+        Histogram durations;
+        Histogram statesCounts;
+        Histogram failureDurations;
+
+        BulkTestInfo& operator += (const BulkTestInfo& other) {
+            totalDuration += other.totalDuration;
+            totalStatesGenerated += other.totalStatesGenerated;
+            totalMoves += other.totalMoves;
+            currentIteration += other.currentIteration;
+            passedIterations += other.passedIterations;
+            failedIterations += other.failedIterations;
+            solutionsChecksum += other.solutionsChecksum;
+            stats += other.stats;
+            allocations += other.allocations;
+            durations += other.durations;
+            statesCounts += other.statesCounts;
+            failureDurations += other.failureDurations;
+            return *this;
+        }
+    };
+
+    // Totals published by the workers while the tests run. Workers publish once
+    // every few iterations, so the lock is rarely contended.
+    class BulkTestProgress
+    {
+    private:
+        mutable std::mutex mutex;
+        BulkTestInfo info;
+
+    public:
+        void Publish(const BulkTestInfo& published) {
+            std::lock_guard<std::mutex> lock(mutex);
+            info += published;
+        }
+
+        BulkTestInfo Snapshot() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return info;
+        }
+    };
+
+    // Solves random boards on every core, independently of the frame loop. Each
+    // worker accumulates its own BulkTestInfo, publishes it every few iterations
+    // for the progress snapshot, and the final result is the sum of the workers.
+    class BulkTestRunner
+    {
+    private:
+        std::shared_ptr<ThreadPool> threadPool;
+        std::future<BulkTestInfo> job;
+        std::shared_ptr<BulkTestProgress> progress;
+        CancellationToken cancellation;
+        BulkTestInfo result;
+
+    public:
+        // One worker per thread of the pool, best shared with the solvers under test.
+        explicit BulkTestRunner(std::shared_ptr<ThreadPool> threadPool = ThreadPool::Shared())
+            : threadPool(std::move(threadPool)), job{}, progress(std::make_shared<BulkTestProgress>()), cancellation{}, result{}
+        {}
+
+        ~BulkTestRunner()
+        {
+            Stop();
+        }
+
+        bool IsRunning() const
+        {
+            return job.valid() && job.wait_for(Microseconds::zero()) != std::future_status::ready;
+        }
+
+        void Start(
+            const std::shared_ptr<Solver> solver,
+            const SolverParam& param,
+            const std::shared_ptr<Heuristic> heuristic,
+            uint32_t boardSize,
+            FigureKind figure,
+            uint32_t iterationsCount,
+            Microseconds timeout,
+            uint64_t seed
+        ) {
+            Stop();
+
+            progress = std::make_shared<BulkTestProgress>();
+            cancellation = CancellationToken{};
+            result = {};
+
+            job = std::async(std::launch::async, [solver, param, heuristic, boardSize, figure, iterationsCount, timeout, seed, threadPool = threadPool, progress = progress, cancellation = cancellation]() {
+                size_t workersCount = threadPool->ThreadsCount();
+                std::vector<BulkTestInfo> workersInfo(workersCount);
+                std::atomic<uint32_t> nextIteration{ 0 };
+
+                threadPool->ParallelFor(workersCount, [&](size_t worker) {
+                    TraceSpan workerSpan("Bulk worker", "bulk");
+
+                    BulkTestInfo& info = workersInfo[worker];
+                    BulkTestInfo unpublished{};
+
+                    uint32_t iteration;
+
+                    while ((iteration = nextIteration.fetch_add(1, std::memory_order_relaxed)) < iterationsCount && !cancellation.IsCancelled()) {
+
+                        TraceSpan runSpan("Bulk run", "bulk");
+
+                        // Boards and solver seeds depend on the seed and the iteration only,
+                        // not on the worker that got it.
+                        uint64_t boardSeed = DeriveSeed(seed, iteration);
+                        Board figuresPositions = RandomBoard(boardSize, boardSeed);
+
+                        SolveContext context = SolveContext::WithTimeout(timeout);
+                        context.cancellation = cancellation;
+                        context.seed = SolverSeed(boardSeed);
+                        context.figure = figure;
+
+                        AllocationCounters allocationCounters;
+                        Solution solution{};
+
+                        {
+                            AllocationScope allocationScope(&allocationCounters);
+                            solution = solver->Solve(figuresPositions, param, heuristic, context);
+                        }
+
+                        // A solve cut short by Stop is not counted either way.
+                        if (solution.timedOut && cancellation.IsCancelled())
+                            break;
+
+                        unpublished.stats += solution.stats;
+                        unpublished.allocations += allocationCounters.Stats();
+
+                        if (!solution.IsSolved()) {
+                            unpublished.failureDurations.Record(solution.duration.count());
+                            unpublished.failedIterations++;
+                        }
+
+                        else {
+                            unpublished.totalDuration += solution.duration.count();
+                            unpublished.totalStatesGenerated += solution.generatedStatesCount;
+                            unpublished.totalMoves += solution.movesCount;
+                            unpublished.durations.Record(solution.duration.count());
+                            unpublished.statesCounts.Record(solution.generatedStatesCount);
+                            unpublished.solutionsChecksum += DeriveSeed(ZobristHash(solution.figuresPositions), iteration);
+                            unpublished.passedIterations++;
+                        }
+
+                        unpublished.currentIteration++;
+
+                        if (unpublished.currentIteration == BULK_TESTS_PUBLISH_PERIOD) {
+                            progress->Publish(unpublished);
+                            info += unpublished;
+                            unpublished = {};
+                        }
+                    }
+
+                    progress->Publish(unpublished);
+                    info += unpublished;
+                });
+
+                BulkTestInfo total{};
+
+                for (auto& info : workersInfo)
+                    total += info;
+
+                return total;
+            });
+        }
+
+        BulkTestInfo Wait()
+        {
+            if (job.valid())
+                result = job.get();
+            return result;
+        }
+
+        // Cancels the running solves and waits for the workers, keeping what they finished.
+        void Stop()
+        {
+            if (!job.valid())
+                return;
+
+            cancellation.Cancel();
+            result = job.get();
+        }
+
+        void Reset()
+        {
+            Stop();
+            result = {};
+        }
+
+        // Final result once the tests are over, otherwise the published progress.
+        BulkTestInfo Snapshot()
+        {
+            if (job.valid() && job.wait_for(Microseconds::zero()) == std::future_status::ready)
+                result = job.get();
+
+            if (job.valid())
+                return progress->Snapshot();
+            return result;
+        }
+    };
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+
+namespace ntf {
+
+    // Cooperative stop request shared by copies of the token. Solvers poll it in
+    // their main loops and return what they have as soon as it is set. A linked
+    // token is cancelled on its own or together with any of its parents.
+    class CancellationToken
+    {
+    private:
+        struct State {
+            std::atomic<bool> cancelled{ false };
+            std::shared_ptr<const State> parent;
+        };
+
+        std::shared_ptr<State> state;
+
+    public:
+        CancellationToken() : state(std::make_shared<State>())
+        {}
+
+        CancellationToken CreateLinked() const
+        {
+            CancellationToken linked;
+            linked.state->parent = state;
+            return linked;
+        }
+
+        void Cancel() const
+        {
+            state->cancelled.store(true, std::memory_order_relaxed);
+        }
+
+        bool IsCancelled() const
+        {
+            for (const State* current = state.get(); current != nullptr; current = current->parent.get()) {
+                if (current->cancelled.load(std::memory_order_relaxed))
+                    return true;
+            }
+
+            return false;
+        }
+    };
+}
@@ -3,16 +3,21 @@
 #include "Figure.h"
 #include "Heuristic.h"
 #include "Solver.h"
-#include <random>
+#include "Threats.h"
+#include "BulkTest.h"
+#include <future>
 
 
 namespace ntf {
     constexpr uint32_t BULK_TESTS_AMOUNT = 10000;
+    constexpr Microseconds SOLVE_TIMEOUT = std::chrono::seconds(10);
+    constexpr size_t SOLVE_LATENCIES_HISTORY_SIZE = 64;
+    constexpr uint32_t SOLVE_LATENCY_BUCKETS_COUNT = 24U;
     constexpr int16_t INVALID_FIGURE = -1;
 
     constexpr uint8_t DEFAULT_BOARD_SIZE = 8U;
-    constexpr int8_t MAX_BOARD_SIZE = 16;
-    constexpr int8_t MIN_BOARD_SIZE = 4;
+    constexpr int8_t MAX_BOARD_SIZE = static_cast<int8_t>(MAX_STATIC_BOARD_SIZE);
+    constexpr int8_t MIN_BOARD_SIZE = static_cast<int8_t>(MIN_STATIC_BOARD_SIZE);
     
     constexpr uint32_t DEFAULT_FIGURE_INDEX = 4U;
     constexpr uint32_t FIGURES_COUNT = 6U;
@@ -20,19 +25,10 @@ namespace ntf {
     enum class TileColor { BLACK, WHITE };
     enum class BoardSide { TOP, RIGHT, BOTTOM, LEFT };
 
-    struct BulkTestInfo {
-        uint64_t totalDuration = 0;
-        uint64_t totalStatesGenerated = 0;
-        uint32_t currentIteration = 0;
-        uint32_t passedIterations = 0;
-        uint32_t failedIterations = 0;
-    };
-
     class ChessBoard : public Screen
     {
     private:
         bool bulkTestsEnabled;
-        bool isRunningBulkTests;
         bool globalHeuristicModeToggled;
         int16_t currentHeuristicResultFigureIndex;
         int16_t selectedFigureIndex;
@@ -43,6 +39,9 @@ namespace ntf {
         uint32_t bulkTestsAmount;
 
         Solution currentSolution;
+        std::future<Solution> solveJob;
+        SolveContext solveContext;
+        RingBuffer<uint64_t, SOLVE_LATENCIES_HISTORY_SIZE> solveLatencies;
 
         olc::vf2d boardPosition;
         olc::vf2d boardSize;
@@ -51,11 +50,15 @@ namespace ntf {
         std::vector<std::shared_ptr<Heuristic>> heuristics;
         std::vector<std::shared_ptr<Solver>> solvers;
 
-        std::vector<olc::vi2d> figuresPositions;
+        Board figuresPositions;
+
+        // Kept in step with figuresPositions for the threat queries of every frame.
+        Bitboard figuresBitboard;
         std::array<std::shared_ptr<Figure>, FIGURES_COUNT> figures;
 
-        std::default_random_engine randomGenerator;
+        uint64_t seed;
         BulkTestInfo bulkTestResults;
+        BulkTestRunner bulkTestRunner;
 
     public:
         ChessBoard(
@@ -64,7 +67,6 @@ namespace ntf {
         ) :
             Screen("Puzzle", olc::P, "P"),
             bulkTestsEnabled(false),
-            isRunningBulkTests(false),
             globalHeuristicModeToggled(false),
             currentHeuristicResultFigureIndex(INVALID_FIGURE),
             selectedFigureIndex(INVALID_FIGURE),
@@ -74,16 +76,26 @@ namespace ntf {
             size(DEFAULT_BOARD_SIZE),
             bulkTestsAmount(BULK_TESTS_AMOUNT),
             currentSolution({}),
+            solveJob{},
+            solveContext{},
             boardPosition{ 0.0f, 0.0f },
             boardSize{ 0.0f, 0.0f },
             tileSize{ 0.0f, 0.0f },
             heuristics(heuristics),
             solvers(solvers),
             figuresPositions{},
+            figuresBitboard{},
             figures{},
-            bulkTestResults{}
+            seed(0),
+            bulkTestResults{},
+            bulkTestRunner{}
         {}
 
+        ~ChessBoard()
+        {
+            DiscardSolve();
+        }
+
     private:
         void DecrementCurrentSolverParam()
         {
@@ -103,8 +115,11 @@ namespace ntf {
             int col = (mouseX - static_cast<int>(boardPosition.x)) / static_cast<int>(tileSize.x);
             int row = (mouseY - static_cast<int>(boardPosition.y)) / static_cast<int>(tileSize.y);
 
-            if (col == selectedFigureIndex)
-                figuresPositions[selectedFigureIndex] = { col, row };
+            if (col == selectedFigureIndex && row >= 0 && row < size) {
+                DiscardSolve();
+                figuresBitboard.Move(col, figuresPositions.Row(col), row);
+                figuresPositions.SetRow(col, row);
+            }
 
             selectedFigureIndex = INVALID_FIGURE;
         }
@@ -121,7 +136,7 @@ namespace ntf {
                     olc::Pixel fillColor{};
                     olc::Pixel borderColor(window->FgColor());
 
-                    if (selectedFigureIndex != INVALID_FIGURE && j != figuresPositions.at(selectedFigureIndex).x)
+                    if (selectedFigureIndex != INVALID_FIGURE && j != selectedFigureIndex)
                         fillColor = window->BgColor();
                     else
                         fillColor = GetTileColor(j, i);
@@ -133,21 +148,66 @@ namespace ntf {
 
         void DrawBulkTestResults()
         {
-            auto [duration, statesCount, currentIteration, passedIterations, failedIterations] = bulkTestResults;
+            const BulkTestInfo& info = bulkTestResults;
 
-            if (currentIteration == 0)
+            if (info.currentIteration == 0)
                 return;
 
-            if (currentIteration < bulkTestsAmount && passedIterations == 0)
-                passedIterations = 1;
+            uint32_t averagedIterations = std::max(info.passedIterations, 1U);
+
+            auto joinPercentiles = [](const Histogram& histogram, std::initializer_list<double> percentiles) {
+                std::string joined{};
+
+                for (double percentile : percentiles)
+                    joined += (joined.empty() ? "" : " / ") + std::to_string(histogram.Percentile(percentile));
+
+                return joined;
+            };
+
+            std::vector<std::string> strings{
+                "Total iterations: " + std::to_string(info.currentIteration) + (bulkTestRunner.IsRunning() ? " (running)" : ""),
+                "Passed iterations: " + std::to_string(info.passedIterations),
+                "Failed iterations: " + std::to_string(info.failedIterations),
+                "Avg. time: " + std::to_string(info.totalDuration / averagedIterations) + " microsec",
+                "Avg. nodes: " + std::to_string(info.totalStatesGenerated / averagedIterations),
+                "Time min/p50/p90/p99/p99.9/max: " + joinPercentiles(info.durations, { 0.0, 50.0, 90.0, 99.0, 99.9, 100.0 }) + " microsec",
+                "Time std. dev.: " + std::to_string(static_cast<uint64_t>(info.durations.StdDev())) + " microsec",
+                "Nodes p50/p99/max: " + joinPercentiles(info.statesCounts, { 50.0, 99.0, 100.0 }),
+            };
+
+            if (info.failedIterations > 0) {
+                strings.push_back(
+                    "Time to failure avg/p50/max: " + std::to_string(static_cast<uint64_t>(info.failureDurations.Mean()))
+                    + " / " + joinPercentiles(info.failureDurations, { 50.0, 100.0 }) + " microsec"
+                );
+            }
+
+            if constexpr (SOLVER_STATS_ENABLED) {
+                const SolverStats& stats = info.stats;
+                auto average = [&](uint64_t total) { return std::to_string(total / info.currentIteration); };
 
-            DrawStrings({
-                "Total iterations: " + std::to_string(currentIteration),
-                "Passed iterations: " + std::to_string(passedIterations),
-                "Failed iterations: " + std::to_string(failedIterations),
-                "Avg. time: " + std::to_string(duration / passedIterations) + " microsec",
-                "Avg. nodes: " + std::to_string(statesCount / passedIterations),
-            }, BoardSide::BOTTOM);
+                strings.push_back("Avg. iterations / evaluations: " + average(stats.iterationsCount) + " / " + average(stats.heuristicEvaluationsCount));
+                strings.push_back(
+                    "Avg. lookups / hits / duplicates: " + average(stats.visitedLookupsCount)
+                    + " / " + average(stats.visitedHitsCount) + " / " + average(stats.duplicatesCount)
+                );
+                strings.push_back(
+                    "Avg. pushes / pops, peak frontier: " + average(stats.queuePushesCount)
+                    + " / " + average(stats.queuePopsCount) + ", " + std::to_string(stats.peakFrontierSize)
+                );
+            }
+
+            if constexpr (ALLOCATION_TRACKING_ENABLED) {
+                const AllocationStats& allocations = info.allocations;
+
+                strings.push_back(
+                    "Avg. allocations / bytes: " + std::to_string(allocations.allocationsCount / info.currentIteration)
+                    + " / " + std::to_string(allocations.allocatedBytes / info.currentIteration)
+                    + ", peak live bytes: " + std::to_string(allocations.peakLiveBytes)
+                );
+            }
+
+            DrawStrings(std::move(strings), BoardSide::BOTTOM);
         }
 
         void DrawFigures()
@@ -160,7 +220,7 @@ namespace ntf {
             };
 
             for (int i = 0; i < size; i++) {
-                auto& position = figuresPositions[i];
+                Square position = figuresPositions.Position(i);
                 olc::vf2d pos{};
 
                 if (i == selectedFigureIndex)
@@ -186,7 +246,7 @@ namespace ntf {
             auto drawHeuristicResult = [&](uint32_t figureIndex) {
                 std::shared_ptr<Heuristic> heuristic = heuristics.at(currentHeuristicIndex);
 
-                auto results = heuristic->EvaluateColumn(figuresPositions[figureIndex], figuresPositions);
+                auto results = heuristic->EvaluateColumn(figuresPositions.Position(figureIndex), figuresPositions, CurrentFigure()->kind);
 
                 auto drawResult = [&](HeuristicValue result) {
                     auto& [position, value] = result;
@@ -197,7 +257,7 @@ namespace ntf {
                     window->DrawString(fgPos, std::to_string(value), GetTileColor(position, true));
                 };
 
-                auto& trgRes = results.at(figuresPositions[figureIndex].y);
+                auto& trgRes = results.at(figuresPositions.Row(figureIndex));
 
                 olc::vf2d tilePos = GetTilePosition(trgRes.position);
                 olc::vf2d bgPos = { tilePos.x, tilePos.y + (tileSize.y / 2.0f) };
@@ -211,7 +271,7 @@ namespace ntf {
             };
 
             if (globalHeuristicModeToggled) {
-                for (uint32_t i = 0; i < figuresPositions.size(); i++)
+                for (uint32_t i = 0; i < figuresPositions.Size(); i++)
                     drawHeuristicResult(i);
             }
 
@@ -222,7 +282,7 @@ namespace ntf {
 
         void DrawSolution()
         {
-            if (currentSolution.figuresPositions.size() == 0 && currentSolution.duration.count() > 0) {
+            if (currentSolution.figuresPositions.Empty() && currentSolution.duration.count() > 0) {
                 DrawStrings(
                     {
                         "Failed to find solution... ",
@@ -233,26 +293,34 @@ namespace ntf {
                 return;
             }
 
-            if (currentSolution.figuresPositions.size() == 0)
+            if (currentSolution.figuresPositions.Empty())
                 return;
 
-            auto& [positions, duration, generatedStatesCount] = currentSolution;
+            const Board& positions = currentSolution.figuresPositions;
 
-            for (size_t i = 0; i < positions.size(); i++) {
-                auto origPos = GetTilePositionI(figuresPositions.at(i)) + tileSize / 2;
-                auto trgPos = GetTilePositionI(positions[i]) + tileSize / 2;
+            for (uint32_t i = 0; i < positions.Size(); i++) {
+                auto origPos = GetTilePositionI(figuresPositions.Position(i)) + tileSize / 2;
+                auto trgPos = GetTilePositionI(positions.Position(i)) + tileSize / 2;
 
                 window->DrawLine(origPos, trgPos, window->AccentColor(), DASHED_LINE_PATTERN);
                 window->FillCircle(trgPos, 2, window->AccentColor());
             }
 
-            DrawStrings(
-                {
-                    "Duration: " + std::to_string(duration.count()) + " microsec.",
-                    "States generated: " + std::to_string(generatedStatesCount)
-                },
-                BoardSide::BOTTOM
-            );
+            std::vector<std::string> strings{
+                "Duration: " + std::to_string(currentSolution.duration.count()) + " microsec.",
+                "States generated: " + std::to_string(currentSolution.generatedStatesCount)
+            };
+
+            if (currentSolution.movesCount > 0)
+                strings.push_back("Moves per sec.: " + std::to_string(static_cast<uint64_t>(currentSolution.MovesPerSecond())));
+
+            if (currentSolution.timedOut)
+                strings.insert(strings.begin(), "Timed out, best board found so far");
+
+            if (!currentSolution.solverName.empty())
+                strings.push_back("Solved by: " + currentSolution.solverName);
+
+            DrawStrings(std::move(strings), BoardSide::BOTTOM);
         }
 
         void DrawStrings(const std::vector<std::string>&& strings, BoardSide side = BoardSide::LEFT) {
@@ -281,7 +349,7 @@ namespace ntf {
             window->DrawRect(GetTilePosition(col, row), tileSize, borderColor);
         }
 
-        void DrawTile(const olc::vi2d& position, const olc::Pixel& fillColor, const olc::Pixel& borderColor)
+        void DrawTile(const Square& position, const olc::Pixel& fillColor, const olc::Pixel& borderColor)
         {
             window->FillRect(GetTilePosition(position), tileSize, fillColor);
             window->DrawRect(GetTilePosition(position), tileSize, borderColor);
@@ -295,10 +363,10 @@ namespace ntf {
             int deltaX = mouseX - static_cast<int>(boardPosition.x);
             int index = deltaX / static_cast<int>(tileSize.x);
 
-            if (index < 0 || index >= figuresPositions.size())
+            if (index < 0 || index >= static_cast<int>(figuresPositions.Size()))
                 return INVALID_FIGURE;
 
-            auto position = GetTilePosition(figuresPositions.at(index));
+            auto position = GetTilePosition(figuresPositions.Position(index));
 
             if (Window::MouseIsInRectBounds(position, tileSize, mouseX, mouseY))
                 return index;
@@ -313,7 +381,7 @@ namespace ntf {
             return (col + row) % 2 == 0 ? window->FgColor() : window->BgColor();
         }
 
-        const olc::Pixel& GetTileColor(const olc::vi2d& position, bool inverse = false)
+        const olc::Pixel& GetTileColor(const Square& position, bool inverse = false)
         {
             return GetTileColor(position.x, position.y, inverse);
         }
@@ -330,7 +398,7 @@ namespace ntf {
             return (col + row) % 2 == 0 ? TileColor::WHITE : TileColor::BLACK;
         }
 
-        TileColor GetTileColorType(const olc::vi2d& position)
+        TileColor GetTileColorType(const Square& position)
         {
             return GetTileColorType(position.x, position.y);
         }
@@ -340,9 +408,9 @@ namespace ntf {
             return olc::vf2d{ static_cast<float>(col), static_cast<float>(row) } * tileSize + boardPosition;
         }
 
-        olc::vf2d GetTilePosition(const olc::vi2d& position)
+        olc::vf2d GetTilePosition(const Square& position)
         {
-            return position * tileSize + boardPosition;
+            return GetTilePosition(position.x, position.y);
         }
 
         olc::vi2d GetTilePositionI(const uint32_t col, const uint32_t row)
@@ -353,7 +421,7 @@ namespace ntf {
             };
         }
 
-        olc::vi2d GetTilePositionI(const olc::vi2d& position)
+        olc::vi2d GetTilePositionI(const Square& position)
         {
             return GetTilePositionI(position.x, position.y);
         }
@@ -365,15 +433,15 @@ namespace ntf {
             if (trgIndex == INVALID_FIGURE)
                 return;
 
-            std::vector<uint32_t> threatIndices(GetThreatsIndices(trgIndex, figuresPositions));
+            ColumnSet threatIndices(GetThreatsIndices(trgIndex, figuresPositions, figuresBitboard, CurrentFigure()->kind));
 
-            if (threatIndices.size() == 0)
+            if (threatIndices.Empty())
                 return;
 
-            olc::vi2d trgPos = GetTilePositionI(figuresPositions.at(trgIndex)) + tileSize / 2.0f;
+            olc::vi2d trgPos = GetTilePositionI(figuresPositions.Position(trgIndex)) + tileSize / 2.0f;
 
-            for (auto& index : threatIndices) {
-                auto threatPosition = GetTilePositionI(figuresPositions.at(index)) + tileSize / 2.0f;
+            for (uint32_t index : threatIndices) {
+                auto threatPosition = GetTilePositionI(figuresPositions.Position(index)) + tileSize / 2.0f;
 
                 window->FillCircle(threatPosition, 2, window->AccentColor());
                 window->DrawLine(trgPos, threatPosition, window->AccentColor(), DASHED_LINE_PATTERN);
@@ -413,21 +481,26 @@ namespace ntf {
 
             currentHeuristicResultFigureIndex = INVALID_FIGURE;
             selectedFigureIndex = INVALID_FIGURE;
+            DiscardSolve();
+            bulkTestRunner.Reset();
             currentSolution = {};
             bulkTestResults = {};
         }
 
         void RandomizePositions()
         {
-            randomGenerator.seed(static_cast<uint32_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count()));
+            RandomizePositions(SplitMix64(static_cast<uint64_t>(HighResClock::now().time_since_epoch().count())));
+        }
 
-            std::uniform_int_distribution uniformDistribution(0, size - 1);
-            
-            figuresPositions.clear();
+        // The seed is shown on screen and drives the board, the solves and the bulk
+        // tests, so a run can be replayed with the headless benchmark.
+        void RandomizePositions(uint64_t newSeed)
+        {
+            DiscardSolve();
+            seed = newSeed;
+            figuresPositions = RandomBoard(size, seed);
+            figuresBitboard = Bitboard(figuresPositions);
             currentSolution = {};
-
-            for (int i = 0; i < size; i++)
-                figuresPositions.push_back({ i, uniformDistribution(randomGenerator) });
         }
 
         void ResetCurrentSolverParam()
@@ -437,27 +510,107 @@ namespace ntf {
             CurrentSolver()->param.value = CurrentSolver()->param.defaultValue;
         }
 
-        void RunBulkTest()
+        bool IsSolving() const
         {
-            if (bulkTestResults.currentIteration == bulkTestsAmount) {
-                isRunningBulkTests = false;
-                return;
-            }
+            return solveJob.valid();
+        }
+
+        // The solve runs on its own thread with copies of the board, param and
+        // heuristic, so the frame loop keeps going and the settings can change meanwhile.
+        void StartSolve()
+        {
+            solveContext = SolveContext::WithTimeout(SOLVE_TIMEOUT);
+            solveContext.progress = std::make_shared<SolveProgress>();
+            solveContext.seed = SolverSeed(seed);
+            solveContext.figure = CurrentFigure()->kind;
+            currentSolution = {};
 
-            auto solution = CurrentSolver()->Solve(figuresPositions, CurrentSolver()->param, CurrentHeuristic());
+            solveJob = std::async(
+                std::launch::async,
+                [solver = CurrentSolver(), positions = figuresPositions, param = CurrentSolver()->param, heuristic = CurrentHeuristic(), context = solveContext]() {
+                    TraceSpan solveSpan("Solve", "ui");
+                    return solver->Solve(positions, param, heuristic, context);
+                }
+            );
+        }
 
-            if (solution.figuresPositions.size() == 0 && solution.duration.count() > 0) {
-                bulkTestResults.failedIterations++;
+        void PollSolve()
+        {
+            if (IsSolving() && solveJob.wait_for(Microseconds::zero()) == std::future_status::ready) {
+                currentSolution = solveJob.get();
+                solveLatencies.Push(currentSolution.duration.count());
             }
+        }
 
-            else {
-                bulkTestResults.totalDuration += solution.duration.count();
-                bulkTestResults.totalStatesGenerated += solution.generatedStatesCount;
-                bulkTestResults.passedIterations++;
+        // The solver returns its best board so far, which PollSolve then picks up.
+        void CancelSolve()
+        {
+            if (IsSolving())
+                solveContext.cancellation.Cancel();
+        }
+
+        // Stops the solve and drops its result, since the board it was solving is about to change.
+        void DiscardSolve()
+        {
+            if (!IsSolving())
+                return;
+
+            solveContext.cancellation.Cancel();
+            solveJob.get();
+        }
+
+        // Histogram of the recent solve durations in power of two microseconds
+        // buckets, shown above the board in the inspection mode.
+        void DrawSolveLatencies()
+        {
+            if (!window->inspectionModeToggled || solveLatencies.Empty())
+                return;
+
+            std::array<uint32_t, SOLVE_LATENCY_BUCKETS_COUNT> counts{};
+
+            for (size_t i = 0; i < solveLatencies.Size(); i++) {
+                uint32_t bucket = 0;
+
+                for (uint64_t duration = solveLatencies[i]; duration > 1 && bucket + 1 < SOLVE_LATENCY_BUCKETS_COUNT; duration >>= 1)
+                    bucket++;
+
+                counts[bucket]++;
             }
 
-            RandomizePositions();
-            bulkTestResults.currentIteration++;
+            std::string label = "Last solve: " + std::to_string(solveLatencies.Last()) + " us";
+            int barWidth = std::max(static_cast<int>(boardSize.x) / static_cast<int>(SOLVE_LATENCY_BUCKETS_COUNT), 1);
+
+            olc::vi2d position = { static_cast<int>(boardPosition.x), STRING_HEIGHT_I + BASE_GAP_I * 2 };
+            olc::vi2d size = { barWidth * static_cast<int>(SOLVE_LATENCY_BUCKETS_COUNT), STRING_HEIGHT_I + PERF_GRAPH_HEIGHT_I + BASE_GAP_I * 2 };
+
+            window->FillRect(position, size, olc::BLUE);
+            window->DrawString({ position.x + BASE_GAP_I, position.y + BASE_GAP_I }, label, olc::WHITE);
+            window->DrawBarGraph(
+                { position.x, position.y + STRING_HEIGHT_I + BASE_GAP_I },
+                PERF_GRAPH_HEIGHT_I,
+                barWidth,
+                counts,
+                counts.size(),
+                static_cast<float>(*std::max_element(counts.begin(), counts.end())),
+                olc::WHITE
+            );
+        }
+
+        void DrawSolveProgress()
+        {
+            if (!IsSolving())
+                return;
+
+            uint32_t bestHeuristicValue = solveContext.progress->bestHeuristicValue.load(std::memory_order_relaxed);
+
+            DrawStrings(
+                {
+                    "Solving... <S> to cancel",
+                    "Iterations: " + std::to_string(solveContext.progress->iterationsCount.load(std::memory_order_relaxed)),
+                    "Best heuristic: " + (bestHeuristicValue == UINT32_MAX ? std::string("-") : std::to_string(bestHeuristicValue))
+                },
+                BoardSide::BOTTOM
+            );
         }
 
     public:
@@ -487,14 +640,29 @@ namespace ntf {
 
         bool DrawSelf(float fElapsedTime) override
         {
-            DrawBoard();
-            DrawFigures();
-            DrawHeuristicResult();
+            PollSolve();
+
+            {
+                TimingScope timing(*window, "DrawBoard");
+                DrawBoard();
+            }
+
+            {
+                TimingScope timing(*window, "DrawFigures");
+                DrawFigures();
+            }
+
+            {
+                TimingScope timing(*window, "DrawHeuristicResult");
+                DrawHeuristicResult();
+            }
+
             DrawSolution();
-            DrawBulkTestResults();
+            DrawSolveProgress();
+            DrawSolveLatencies();
 
-            if (bulkTestsEnabled && isRunningBulkTests)
-                RunBulkTest();
+            bulkTestResults = bulkTestRunner.Snapshot();
+            DrawBulkTestResults();
 
             BoundingRect info = window->DrawTextBox(
                 { BASE_GAP_I, static_cast<int>(boardPosition.y) },
@@ -506,6 +674,7 @@ namespace ntf {
                     "Global heuristic mode: " + std::to_string(globalHeuristicModeToggled),
                     "Solution: " + CurrentSolver()->name,
                     CurrentSolverParamString(),
+                    "Seed: " + std::to_string(seed),
                 }
             );
 
@@ -555,20 +724,30 @@ namespace ntf {
 
             else if (bulkTestsEnabled && window->GetKey(olc::CTRL).bHeld && window->GetKey(olc::B).bPressed) {
                 
-                if (isRunningBulkTests) 
-                    isRunningBulkTests = false;
-                else {
-                    isRunningBulkTests = true;
-                    bulkTestResults = {};
-                }
+                if (bulkTestRunner.IsRunning())
+                    bulkTestRunner.Stop();
+                else
+                    bulkTestRunner.Start(
+                        CurrentSolver(),
+                        CurrentSolver()->param,
+                        CurrentHeuristic(),
+                        size,
+                        CurrentFigure()->kind,
+                        bulkTestsAmount,
+                        SOLVE_TIMEOUT,
+                        seed
+                    );
             }
             /* FOR BULK TESTS ::END:: */
 
             else if (window->GetKey(olc::SHIFT).bHeld && Window::MouseIsInRectBounds(boardPosition, boardSize, window->GetMouseX(), window->GetMouseY()))
                 HighlightThreats();
 
-            else if (window->GetKey(olc::C).bPressed)
+            else if (window->GetKey(olc::C).bPressed) {
+                DiscardSolve();
+                currentSolution = {};
                 currentFigureIndex = Window::GetNextArrayIndex(currentFigureIndex, figures.size());
+            }
 
             else if (window->GetKey(olc::G).bPressed)
                 globalHeuristicModeToggled = !globalHeuristicModeToggled;
@@ -583,8 +762,10 @@ namespace ntf {
                 RandomizePositions();
 
             else if (window->GetKey(olc::S).bPressed) {
-                DrawStrings({ "Solving..." }, BoardSide::BOTTOM);
-                currentSolution = CurrentSolver()->Solve(figuresPositions, CurrentSolver()->param, CurrentHeuristic());
+                if (IsSolving())
+                    CancelSolve();
+                else
+                    StartSolve();
             }
 
             else if (window->GetKey(olc::RIGHT).bPressed)
@@ -609,12 +790,12 @@ namespace ntf {
         {
             this->window = window;
 
-            std::shared_ptr<Figure> bishop (std::make_shared<Figure>("Bishop", window->GetThemeFilesPaths("black_bishop.png"), window->GetThemeFilesPaths("white_bishop.png"), window));
-            std::shared_ptr<Figure> king   (std::make_shared<Figure>("King",   window->GetThemeFilesPaths("black_king.png"),   window->GetThemeFilesPaths("white_king.png"),   window));
-            std::shared_ptr<Figure> knight (std::make_shared<Figure>("Knight", window->GetThemeFilesPaths("black_knight.png"), window->GetThemeFilesPaths("white_knight.png"), window));
-            std::shared_ptr<Figure> pawn   (std::make_shared<Figure>("Pawn",   window->GetThemeFilesPaths("black_pawn.png"),   window->GetThemeFilesPaths("white_pawn.png"),   window));
-            std::shared_ptr<Figure> queen  (std::make_shared<Figure>("Queen",  window->GetThemeFilesPaths("black_queen.png"),  window->GetThemeFilesPaths("white_queen.png"),  window));
-            std::shared_ptr<Figure> rook   (std::make_shared<Figure>("Rook",   window->GetThemeFilesPaths("black_rook.png"),   window->GetThemeFilesPaths("white_rook.png"),   window));
+            std::shared_ptr<Figure> bishop (std::make_shared<Figure>("Bishop", FigureKind::BISHOP, window->GetThemeFilesPaths("black_bishop.png"), window->GetThemeFilesPaths("white_bishop.png"), window));
+            std::shared_ptr<Figure> king   (std::make_shared<Figure>("King",   FigureKind::KING,   window->GetThemeFilesPaths("black_king.png"),   window->GetThemeFilesPaths("white_king.png"),   window));
+            std::shared_ptr<Figure> knight (std::make_shared<Figure>("Knight", FigureKind::KNIGHT, window->GetThemeFilesPaths("black_knight.png"), window->GetThemeFilesPaths("white_knight.png"), window));
+            std::shared_ptr<Figure> pawn   (std::make_shared<Figure>("Pawn",   FigureKind::PAWN,   window->GetThemeFilesPaths("black_pawn.png"),   window->GetThemeFilesPaths("white_pawn.png"),   window));
+            std::shared_ptr<Figure> queen  (std::make_shared<Figure>("Queen",  FigureKind::QUEEN,  window->GetThemeFilesPaths("black_queen.png"),  window->GetThemeFilesPaths("white_queen.png"),  window));
+            std::shared_ptr<Figure> rook   (std::make_shared<Figure>("Rook",   FigureKind::ROOK,   window->GetThemeFilesPaths("black_rook.png"),   window->GetThemeFilesPaths("white_rook.png"),   window));
   
             figures = { bishop, king, knight, pawn, queen, rook };
 
@@ -623,29 +804,5 @@ namespace ntf {
 
             return true;
         }
-
-        static bool FigureAtPosIsThreat(const olc::vi2d& posA, const olc::vi2d& posB)
-        {
-            if (posA == posB)
-                return false;
-            return posA.y == posB.y || std::abs(posA.x - posB.x) == std::abs(posA.y - posB.y);
-        }
-
-        static std::vector<uint32_t> GetThreatsIndicesForPos(const olc::vi2d& trgPos, const std::vector<olc::vi2d>& positions)
-        {
-            std::vector<uint32_t> threats{};
-
-            for (uint32_t i = 0; i < positions.size(); i++) {
-                if (FigureAtPosIsThreat(trgPos, positions[i]))
-                    threats.push_back(i);
-            }
-
-            return threats;
-        }
-
-        static std::vector<uint32_t> GetThreatsIndices(const uint32_t trgIndex, const std::vector<olc::vi2d>& positions)
-        {
-            return GetThreatsIndicesForPos(positions.at(trgIndex), positions);
-        }
     };
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include "AttackTable.h"
 #include "Window.h"
 
 
@@ -7,16 +8,18 @@ namespace ntf {
     {
     public:
         std::string name;
+        FigureKind kind;
 
         std::vector<std::shared_ptr<olc::Sprite>> blackSprites;
         std::vector<std::shared_ptr<olc::Sprite>> whiteSprites;
 
         Figure(
             const std::string& name,
+            FigureKind kind,
             const std::vector<std::string>& blackSpritePaths,
             const std::vector<std::string>& whiteSpritePaths,
             const std::shared_ptr<Window> window
-        ) : name(name), blackSprites{}, whiteSprites{}
+        ) : name(name), kind(kind), blackSprites{}, whiteSprites{}
         {
             for (auto& spritePath : blackSpritePaths)
                 blackSprites.push_back(std::make_shared<olc::Sprite>(spritePath, window->resourcePack));
@@ -27,10 +30,11 @@ namespace ntf {
 
         Figure(
             std::string&& name,
+            FigureKind kind,
             std::vector<std::string>&& blackSpritePaths,
             std::vector<std::string>&& whiteSpritePaths,
             const std::shared_ptr<Window> window
-        ) : name(std::move(name)), blackSprites{}, whiteSprites{}
+        ) : name(std::move(name)), kind(kind), blackSprites{}, whiteSprites{}
         {
             for (auto& spritePath : blackSpritePaths)
                 blackSprites.push_back(std::make_shared<olc::Sprite>(spritePath, window->resourcePack));
@@ -8,34 +8,14 @@ namespace ntf {
 	public:
 		GlobalThreats() : Heuristic("Global Threats") {}
 
-		HeuristicValue EvaluatePosition(
-			const olc::vi2d& position,
-			const std::vector<olc::vi2d>& figuresPositions
-		) override
+		uint32_t ScorePosition(uint32_t /*attackersCount*/, uint32_t conflictsCount) override
 		{
-			uint32_t threatsSum = 0;
-			size_t boardSize = figuresPositions.size();
-
-			for (size_t i = 0; i < boardSize; i++) {
-				uint32_t threats = 0;
-				olc::vi2d posA = i == position.x ? position : figuresPositions[i];
-
-				for (size_t j = i + 1; j < boardSize; j++) {
-					olc::vi2d posB = j == position.x ? position : figuresPositions[j];
-
-					if (ChessBoard::FigureAtPosIsThreat(posA, posB))
-						threats++;
-				}
-
-				threatsSum += threats;
-			}
-
-			return { position, threatsSum };
-		};
+			return conflictsCount;
+		}
 
-		uint32_t EvaluateBoard(const std::vector<olc::vi2d>& figuresPositions) override
+		uint32_t ScoreBoard(uint32_t conflictsCount) override
 		{
-			return EvaluatePosition(figuresPositions[0], figuresPositions).value;
+			return conflictsCount;
 		}
 	};
 }
\ No newline at end of file
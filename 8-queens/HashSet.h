@@ -0,0 +1,189 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+
+namespace ntf {
+    constexpr size_t HASH_SET_MIN_CAPACITY = 16;
+
+    // Open addressing set of 64-bit keys with linear probing. Zero marks an empty
+    // slot, so the zero key is tracked by a separate flag.
+    class HashSet
+    {
+    private:
+        std::vector<uint64_t> slots;
+        size_t count;
+        bool containsZero;
+
+    public:
+        class Iterator
+        {
+        private:
+            const HashSet* set;
+            size_t index;
+
+        public:
+            Iterator(const HashSet* set, size_t index) : set(set), index(index)
+            {
+                SkipEmpty();
+            }
+
+            uint64_t operator * () const
+            {
+                return index == set->slots.size() ? 0 : set->slots[index];
+            }
+
+            Iterator& operator ++ ()
+            {
+                index++;
+                SkipEmpty();
+                return *this;
+            }
+
+            bool operator == (const Iterator& other) const { return index == other.index; }
+            bool operator != (const Iterator& other) const { return index != other.index; }
+
+        private:
+            void SkipEmpty()
+            {
+                while (index < set->slots.size() && set->slots[index] == 0)
+                    index++;
+            }
+        };
+
+        HashSet() : slots(HASH_SET_MIN_CAPACITY, 0), count(0), containsZero(false) {}
+
+        size_t Size() const { return count; }
+
+        bool Empty() const { return count == 0; }
+
+        bool Contains(uint64_t key) const
+        {
+            if (key == 0)
+                return containsZero;
+
+            for (size_t i = HomeIndex(key); ; i = NextIndex(i)) {
+                if (slots[i] == key)
+                    return true;
+                if (slots[i] == 0)
+                    return false;
+            }
+        }
+
+        bool Insert(uint64_t key)
+        {
+            if (key == 0) {
+                if (containsZero)
+                    return false;
+
+                containsZero = true;
+                count++;
+                return true;
+            }
+
+            if ((count + 1) * 4 > slots.size() * 3)
+                Rehash(slots.size() * 2);
+
+            size_t i = HomeIndex(key);
+
+            for (; slots[i] != 0; i = NextIndex(i)) {
+                if (slots[i] == key)
+                    return false;
+            }
+
+            slots[i] = key;
+            count++;
+            return true;
+        }
+
+        bool Erase(uint64_t key)
+        {
+            if (key == 0) {
+                if (!containsZero)
+                    return false;
+
+                containsZero = false;
+                count--;
+                return true;
+            }
+
+            size_t i = HomeIndex(key);
+
+            for (; slots[i] != key; i = NextIndex(i)) {
+                if (slots[i] == 0)
+                    return false;
+            }
+
+            // Backward shift deletion keeps probe sequences intact without tombstones.
+            for (size_t j = NextIndex(i); slots[j] != 0; j = NextIndex(j)) {
+                size_t home = HomeIndex(slots[j]);
+
+                if (((j - home) & Mask()) >= ((j - i) & Mask())) {
+                    slots[i] = slots[j];
+                    i = j;
+                }
+            }
+
+            slots[i] = 0;
+            count--;
+            return true;
+        }
+
+        void Clear()
+        {
+            std::fill(slots.begin(), slots.end(), 0);
+            count = 0;
+            containsZero = false;
+        }
+
+        void Reserve(size_t capacity)
+        {
+            size_t required = HASH_SET_MIN_CAPACITY;
+
+            while (required * 3 < capacity * 4)
+                required *= 2;
+
+            if (required > slots.size())
+                Rehash(required);
+        }
+
+        Iterator begin() const
+        {
+            return Iterator(this, 0);
+        }
+
+        Iterator end() const
+        {
+            return containsZero ? Iterator(this, slots.size() + 1) : Iterator(this, slots.size());
+        }
+
+    private:
+        size_t Mask() const { return slots.size() - 1; }
+
+        size_t HomeIndex(uint64_t key) const
+        {
+            return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & Mask();
+        }
+
+        size_t NextIndex(size_t index) const { return (index + 1) & Mask(); }
+
+        void Rehash(size_t capacity)
+        {
+            std::vector<uint64_t> oldSlots(capacity, 0);
+            oldSlots.swap(slots);
+
+            for (uint64_t key : oldSlots) {
+                if (key == 0)
+                    continue;
+
+                size_t i = HomeIndex(key);
+
+                while (slots[i] != 0)
+                    i = NextIndex(i);
+
+                slots[i] = key;
+            }
+        }
+    };
+}
@@ -24,7 +24,7 @@ namespace ntf {
                 "<R> - Randomize",
                 "<T> - Change theme",
                 "<G> - Toggle global heuristic mode",
-                "<S> - Solve",
+                "<S> - Solve / cancel solving",
                 "<Ctrl> + <J> - Decrease solver param",
                 "<Ctrl> + <K> - Increase solver param",
                 "<Ctrl> + <R> - Reset solver param",
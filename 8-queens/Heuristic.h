@@ -1,12 +1,14 @@
 #pragma once
-#include "olcPixelGameEngine.h"
+#include "ThreatCounters.h"
+#include <memory>
 #include <queue>
+#include <string>
 
 
 namespace ntf {
 
     struct HeuristicValue {
-        olc::vi2d position;
+        Square position;
         uint32_t  value;
 
         bool operator == (const HeuristicValue& other) const {
@@ -30,24 +32,67 @@ namespace ntf {
         Heuristic(const std::string& name) : name(name) {}
         Heuristic(std::string&& name) : name(std::move(name)) {}
 
-        virtual HeuristicValue EvaluatePosition(
-            const olc::vi2d& position,
-            const std::vector<olc::vi2d>& figuresPositions
-        ) = 0;
+        // Score of a square, given the figures (outside of its column) attacking it
+        // and the conflicting pairs of the board once its column figure moves there.
+        virtual uint32_t ScorePosition(uint32_t attackersCount, uint32_t conflictsCount) = 0;
 
-        virtual uint32_t EvaluateBoard(const std::vector<olc::vi2d>& figuresPositions) = 0;
+        // Score of a whole board with the given amount of conflicting pairs.
+        virtual uint32_t ScoreBoard(uint32_t conflictsCount) = 0;
+
+        template<typename Counters>
+        uint32_t EvaluatePosition(const Counters& counters, uint32_t col, uint32_t row)
+        {
+            return ScorePosition(counters.AttackersAt(col, row), counters.ConflictsAfterMove(col, row));
+        }
+
+        template<typename Counters>
+        uint32_t EvaluateBoard(const Counters& counters)
+        {
+            return ScoreBoard(counters.ConflictsCount());
+        }
+
+        template<typename Counters>
+        uint32_t EvaluateMove(const Counters& counters, uint32_t col, uint32_t row)
+        {
+            return ScoreBoard(counters.ConflictsAfterMove(col, row));
+        }
+
+        template<typename Counters>
+        void EvaluateColumn(const Counters& counters, uint32_t col, std::vector<HeuristicValue>& values)
+        {
+            values.clear();
+
+            for (uint32_t i = 0; i < counters.Size(); i++)
+                values.push_back({ { static_cast<int>(col), static_cast<int>(i) }, EvaluatePosition(counters, col, i) });
+        }
+
+        HeuristicValue EvaluatePosition(
+            const Square& position,
+            const Board& figuresPositions,
+            FigureKind figure = FigureKind::QUEEN
+        ) {
+            ThreatCounters counters(figuresPositions, figure);
+            return { position, EvaluatePosition(counters, position.x, position.y) };
+        }
+
+        uint32_t EvaluateBoard(const Board& figuresPositions, FigureKind figure = FigureKind::QUEEN)
+        {
+            return EvaluateBoard(ThreatCounters(figuresPositions, figure));
+        }
 
         HeuristicValue GetColumnMinValue(
-            const olc::vi2d& currentPos,
-            const std::vector<olc::vi2d>& figuresPositions
+            const Square& currentPos,
+            const Board& figuresPositions,
+            FigureKind figure = FigureKind::QUEEN
         ) {
-            if (figuresPositions.size() < 0)
+            if (figuresPositions.Empty())
                 return {};
 
-            HeuristicValue minValue = EvaluatePosition({ currentPos.x, 0 }, figuresPositions);
+            ThreatCounters counters(figuresPositions, figure);
+            HeuristicValue minValue = { { currentPos.x, 0 }, EvaluatePosition(counters, currentPos.x, 0) };
 
-            for (size_t i = 1; i < figuresPositions.size(); i++) {
-                auto value = EvaluatePosition({ currentPos.x, static_cast<int>(i) }, figuresPositions);
+            for (uint32_t i = 1; i < figuresPositions.Size(); i++) {
+                HeuristicValue value = { { currentPos.x, static_cast<int>(i) }, EvaluatePosition(counters, currentPos.x, i) };
 
                 if (value < minValue)
                     minValue = value;
@@ -57,13 +102,12 @@ namespace ntf {
         }
 
         std::vector<HeuristicValue> EvaluateColumn(
-            const olc::vi2d& currentPos,
-            const std::vector<olc::vi2d>& figuresPositions
+            const Square& currentPos,
+            const Board& figuresPositions,
+            FigureKind figure = FigureKind::QUEEN
         ) {
             std::vector<HeuristicValue> values{};
-
-            for (size_t i = 0; i < figuresPositions.size(); i++)
-                values.push_back(EvaluatePosition({ currentPos.x, static_cast<int>(i) }, figuresPositions));
+            EvaluateColumn(ThreatCounters(figuresPositions, figure), currentPos.x, values);
 
             return values;
         }
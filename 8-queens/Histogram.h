@@ -0,0 +1,135 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+
+namespace ntf {
+    constexpr uint32_t HISTOGRAM_SUB_BUCKET_BITS = 5U;
+    constexpr uint32_t HISTOGRAM_SUB_BUCKETS_COUNT = 1U << HISTOGRAM_SUB_BUCKET_BITS;
+    constexpr uint32_t HISTOGRAM_BUCKETS_COUNT = (64U - HISTOGRAM_SUB_BUCKET_BITS + 1U) * HISTOGRAM_SUB_BUCKETS_COUNT;
+
+    // HDR style histogram of non-negative values. Every power of two is split into
+    // 32 linear sub-buckets, so a recorded value is kept with about 3% precision in
+    // a fixed 8 KB of counts whatever its magnitude. Min, max, mean and standard
+    // deviation are exact, percentiles are the upper bounds of their buckets.
+    class Histogram
+    {
+    private:
+        std::array<uint32_t, HISTOGRAM_BUCKETS_COUNT> counts;
+        uint64_t totalCount;
+        uint64_t minValue;
+        uint64_t maxValue;
+        double sum;
+        double squaresSum;
+
+        static uint32_t BucketIndex(uint64_t value)
+        {
+            if (value < HISTOGRAM_SUB_BUCKETS_COUNT)
+                return static_cast<uint32_t>(value);
+
+            uint32_t shift = Magnitude(value) - HISTOGRAM_SUB_BUCKET_BITS;
+            uint32_t subBucket = static_cast<uint32_t>(value >> shift) & (HISTOGRAM_SUB_BUCKETS_COUNT - 1);
+
+            return (shift + 1) * HISTOGRAM_SUB_BUCKETS_COUNT + subBucket;
+        }
+
+        static uint64_t BucketUpperBound(uint32_t index)
+        {
+            if (index < HISTOGRAM_SUB_BUCKETS_COUNT)
+                return index;
+
+            uint32_t shift = index / HISTOGRAM_SUB_BUCKETS_COUNT - 1;
+            uint64_t subBucket = index % HISTOGRAM_SUB_BUCKETS_COUNT + HISTOGRAM_SUB_BUCKETS_COUNT;
+
+            return ((subBucket + 1) << shift) - 1;
+        }
+
+        // Index of the highest set bit.
+        static uint32_t Magnitude(uint64_t value)
+        {
+            uint32_t magnitude = 0;
+
+            for (uint32_t shift = 32; shift > 0; shift /= 2) {
+                if ((value >> shift) != 0) {
+                    value >>= shift;
+                    magnitude += shift;
+                }
+            }
+
+            return magnitude;
+        }
+
+    public:
+        Histogram() : counts{}, totalCount(0), minValue(UINT64_MAX), maxValue(0), sum(0.0), squaresSum(0.0) {}
+
+        void Record(uint64_t value)
+        {
+            counts[BucketIndex(value)]++;
+            totalCount++;
+            minValue = std::min(minValue, value);
+            maxValue = std::max(maxValue, value);
+            sum += static_cast<double>(value);
+            squaresSum += static_cast<double>(value) * static_cast<double>(value);
+        }
+
+        Histogram& operator += (const Histogram& other)
+        {
+            if (other.totalCount == 0)
+                return *this;
+
+            for (uint32_t i = 0; i < HISTOGRAM_BUCKETS_COUNT; i++)
+                counts[i] += other.counts[i];
+
+            totalCount += other.totalCount;
+            minValue = std::min(minValue, other.minValue);
+            maxValue = std::max(maxValue, other.maxValue);
+            sum += other.sum;
+            squaresSum += other.squaresSum;
+
+            return *this;
+        }
+
+        uint64_t Count() const { return totalCount; }
+
+        uint64_t Min() const { return totalCount == 0 ? 0 : minValue; }
+
+        uint64_t Max() const { return maxValue; }
+
+        double Mean() const
+        {
+            return totalCount == 0 ? 0.0 : sum / static_cast<double>(totalCount);
+        }
+
+        double StdDev() const
+        {
+            if (totalCount == 0)
+                return 0.0;
+
+            double mean = Mean();
+            return std::sqrt(std::max(squaresSum / static_cast<double>(totalCount) - mean * mean, 0.0));
+        }
+
+        // Smallest bucket bound with at least the given percentage of values at or below it.
+        uint64_t Percentile(double percentile) const
+        {
+            if (totalCount == 0)
+                return 0;
+
+            uint64_t targetCount = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(totalCount)));
+            targetCount = std::max<uint64_t>(targetCount, 1);
+
+            uint64_t runningCount = 0;
+
+            for (uint32_t i = 0; i < HISTOGRAM_BUCKETS_COUNT; i++) {
+                runningCount += counts[i];
+
+                if (runningCount >= targetCount)
+                    return std::min(std::max(BucketUpperBound(i), Min()), maxValue);
+            }
+
+            return maxValue;
+        }
+    };
+}
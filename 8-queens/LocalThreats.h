@@ -8,25 +8,15 @@ namespace ntf {
 	public:
 		LocalThreats() : Heuristic("Local Threats") {}
 
-		HeuristicValue EvaluatePosition(
-			const olc::vi2d& position,
-			const std::vector<olc::vi2d>& figuresPositions
-		) override
+		uint32_t ScorePosition(uint32_t attackersCount, uint32_t /*conflictsCount*/) override
 		{
-			return {
-				position,
-				static_cast<uint32_t>(ChessBoard::GetThreatsIndicesForPos(position, figuresPositions).size())
-			};
+			return attackersCount;
 		}
 
-		uint32_t EvaluateBoard(const std::vector<olc::vi2d>& figuresPositions) override
+		// Sum of local threats of every figure, each conflicting pair is seen from both of its ends.
+		uint32_t ScoreBoard(uint32_t conflictsCount) override
 		{
-			uint32_t result = 0;
-
-			for (uint32_t i = 0; i < figuresPositions.size(); i++)
-				result += EvaluatePosition(figuresPositions[i], figuresPositions).value;
-
-			return result;
+			return conflictsCount * 2;
 		}
 	};
 }
\ No newline at end of file
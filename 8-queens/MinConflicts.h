@@ -0,0 +1,262 @@
+#pragma once
+#include "Solver.h"
+#include <random>
+
+
+namespace ntf {
+	constexpr uint64_t MIN_CONFLICTS_STEPS_PER_FIGURE = 64U;
+	constexpr uint64_t MIN_CONFLICTS_MIN_STEPS = 100000U;
+	constexpr uint32_t MIN_CONFLICTS_NOISE_PERIOD = 8U;
+	constexpr uint64_t MIN_CONFLICTS_STALL_STEPS = 256U;
+	constexpr uint64_t MIN_CONFLICTS_CLOCK_PERIOD = 64U;
+	constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+	// Min-conflicts search for boards of any size. Figures are placed greedily on
+	// distinct rows, so only diagonal conflicts remain, which are then repaired
+	// by swapping rows of a conflicted column with the best of the sampled columns.
+	// Memory is linear in the board size and every step costs O(samples). Moves
+	// are scored with the solver's own conflicts counts, not the given heuristic.
+	// Other figures keep the distinct rows too, which never loses every solution:
+	// queen solutions are solutions for all of them but knights, and knights can
+	// all stand on the diagonal.
+	class MinConflicts : public Solver
+	{
+	public:
+		using Solver::Solve;
+
+		MinConflicts(const SolverParam& param) : Solver("Min Conflicts", param) {}
+
+		// When stopped by the context the current board is returned, since copying
+		// the best one on every improvement would not pay off on large boards.
+		Solution Solve(
+			const Board& figuresPositions,
+			const SolverParam& param,
+			const std::shared_ptr<Heuristic> /*heuristic*/,
+			const SolveContext& context
+		) override
+		{
+			SolverStatsCounter stats;
+
+			Solution solution = SolveWithStats(figuresPositions, param, context, stats);
+			solution.stats = stats.Stats();
+			return solution;
+		}
+
+	private:
+		Solution SolveWithStats(
+			const Board& figuresPositions,
+			const SolverParam& param,
+			const SolveContext& context,
+			SolverStatsCounter& stats
+		) {
+			auto startTime = HighResClock::now();
+			uint64_t generatedStatesCount = 0;
+			uint64_t movesCount = 0;
+
+			const uint32_t size = figuresPositions.Size();
+			const uint32_t samplesCount = static_cast<uint32_t>(std::max(param.value, 1));
+
+			if (size == 0)
+				return Unsolved(startTime, generatedStatesCount, movesCount);
+
+			std::mt19937_64 randomEngine(context.seed);
+			std::uniform_int_distribution<uint32_t> columnDistribution(0, size - 1);
+
+			ThreatCounters counters(context.figure);
+			generatedStatesCount += PlaceGreedily(figuresPositions, samplesCount, counters, randomEngine);
+			stats.CountHeuristicEvaluations(generatedStatesCount);
+			movesCount += size;
+
+			std::vector<uint32_t> worklist{};
+			std::vector<uint32_t> worklistIndex(size, INVALID_INDEX);
+
+			auto addToWorklist = [&](uint32_t col) {
+				if (worklistIndex[col] != INVALID_INDEX || counters.AttackersAt(col, counters.Positions().Row(col)) == 0)
+					return;
+
+				worklistIndex[col] = static_cast<uint32_t>(worklist.size());
+				worklist.push_back(col);
+			};
+
+			auto removeFromWorklist = [&](uint32_t col) {
+				uint32_t index = worklistIndex[col];
+
+				worklist[index] = worklist.back();
+				worklistIndex[worklist[index]] = index;
+				worklist.pop_back();
+				worklistIndex[col] = INVALID_INDEX;
+			};
+
+			const uint64_t maxSteps = std::max(size * MIN_CONFLICTS_STEPS_PER_FIGURE, MIN_CONFLICTS_MIN_STEPS);
+
+			TraceSpan repairSpan("Min conflicts repair");
+
+			uint32_t leastConflictsCount = counters.ConflictsCount();
+			uint64_t lastImprovementStep = 0;
+
+			for (uint64_t step = 0; counters.ConflictsCount() > 0 && step < maxSteps; step++) {
+
+				if (step % MIN_CONFLICTS_CLOCK_PERIOD == 0)
+					context.ReportProgress(step, leastConflictsCount);
+
+				if (context.ShouldStop(step, MIN_CONFLICTS_CLOCK_PERIOD))
+					return TimedOut(counters.Positions(), startTime, generatedStatesCount, movesCount);
+
+				stats.CountIteration();
+
+				if (counters.ConflictsCount() < leastConflictsCount) {
+					leastConflictsCount = counters.ConflictsCount();
+					lastImprovementStep = step;
+				}
+
+				// Small boards can get stuck on plateaus, where sampling never finds
+				// a better swap, so the board is shaken by random swaps.
+				else if (step - lastImprovementStep > MIN_CONFLICTS_STALL_STEPS + size) {
+					for (uint32_t i = 0; i < size; i++)
+						SwapRows(counters, columnDistribution(randomEngine), columnDistribution(randomEngine));
+
+					movesCount += size;
+					leastConflictsCount = counters.ConflictsCount();
+					lastImprovementStep = step;
+
+					while (!worklist.empty())
+						removeFromWorklist(worklist.back());
+				}
+
+				// Columns that became conflicted as a side effect of a swap are not
+				// tracked, they are picked up by a full rescan once the worklist runs dry.
+				if (worklist.empty()) {
+					for (uint32_t col = 0; col < size; col++)
+						addToWorklist(col);
+
+					if (worklist.empty())
+						continue;
+
+					stats.CountFrontierSize(worklist.size());
+				}
+
+				uint32_t col = worklist[randomEngine() % worklist.size()];
+
+				if (counters.AttackersAt(col, counters.Positions().Row(col)) == 0) {
+					removeFromWorklist(col);
+					continue;
+				}
+
+				int64_t bestDelta = INT64_MAX;
+				uint32_t bestCol = col;
+
+				for (uint32_t i = 0; i < samplesCount; i++) {
+					uint32_t otherCol = samplesCount >= size - 1 ? i : columnDistribution(randomEngine);
+
+					if (otherCol >= size)
+						break;
+
+					if (otherCol == col)
+						continue;
+
+					uint32_t conflictsCount = counters.ConflictsCount();
+
+					SwapRows(counters, col, otherCol);
+					int64_t delta = static_cast<int64_t>(counters.ConflictsCount()) - conflictsCount;
+					SwapRows(counters, col, otherCol);
+
+					generatedStatesCount++;
+					stats.CountHeuristicEvaluations();
+
+					if (delta < bestDelta || (delta == bestDelta && randomEngine() % 2 == 0)) {
+						bestDelta = delta;
+						bestCol = otherCol;
+					}
+				}
+
+				if (bestCol == col || (bestDelta > 0 && randomEngine() % MIN_CONFLICTS_NOISE_PERIOD != 0))
+					continue;
+
+				SwapRows(counters, col, bestCol);
+				movesCount++;
+
+				if (counters.AttackersAt(col, counters.Positions().Row(col)) == 0)
+					removeFromWorklist(col);
+
+				addToWorklist(bestCol);
+			}
+
+			if (counters.ConflictsCount() != 0)
+				return Unsolved(startTime, generatedStatesCount, movesCount);
+
+			return Solved(counters.Positions(), startTime, generatedStatesCount, movesCount);
+		}
+
+		static void SwapRows(ThreatCounters& counters, uint32_t colA, uint32_t colB)
+		{
+			uint32_t rowA = counters.Positions().Row(colA);
+			uint32_t rowB = counters.Positions().Row(colB);
+
+			counters.Move(colA, rowB);
+			counters.Move(colB, rowA);
+		}
+
+		// Places figures column by column on distinct rows, keeping the row of the
+		// initial board when it is free of conflicts and otherwise picking the least
+		// attacked of the sampled free rows. Returns the amount of evaluated rows.
+		static uint64_t PlaceGreedily(
+			const Board& figuresPositions,
+			uint32_t samplesCount,
+			ThreatCounters& counters,
+			std::mt19937_64& randomEngine
+		) {
+			TraceSpan placementSpan("Min conflicts placement");
+
+			uint64_t evaluatedCount = 0;
+			uint32_t size = figuresPositions.Size();
+
+			std::vector<uint32_t> freeRows(size);
+			std::vector<uint32_t> freeRowIndex(size);
+
+			for (uint32_t i = 0; i < size; i++) {
+				freeRows[i] = i;
+				freeRowIndex[i] = i;
+			}
+
+			counters.Clear(size);
+
+			for (uint32_t col = 0; col < size; col++) {
+				uint32_t initialRow = figuresPositions.Row(col);
+				uint32_t bestRow = freeRows[0];
+				uint32_t bestCount = UINT32_MAX;
+
+				if (freeRowIndex[initialRow] != INVALID_INDEX) {
+					bestRow = initialRow;
+					bestCount = counters.CountAt(col, initialRow);
+					evaluatedCount++;
+				}
+
+				bool scanAll = freeRows.size() <= samplesCount;
+				uint32_t trialsCount = scanAll ? static_cast<uint32_t>(freeRows.size()) : samplesCount;
+
+				for (uint32_t i = 0; i < trialsCount && bestCount != 0; i++) {
+					uint32_t row = scanAll ? freeRows[i] : freeRows[randomEngine() % freeRows.size()];
+					uint32_t count = counters.CountAt(col, row);
+
+					evaluatedCount++;
+
+					if (count < bestCount) {
+						bestCount = count;
+						bestRow = row;
+					}
+				}
+
+				uint32_t index = freeRowIndex[bestRow];
+
+				freeRows[index] = freeRows.back();
+				freeRowIndex[freeRows[index]] = index;
+				freeRows.pop_back();
+				freeRowIndex[bestRow] = INVALID_INDEX;
+
+				counters.Place(col, bestRow);
+			}
+
+			return evaluatedCount;
+		}
+	};
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include "Backtracking.h"
+#include "ThreadPool.h"
+
+
+namespace ntf {
+    // Columns fixed by every subtask. Three columns split the queens board of 18
+    // into about 1700 subtasks, enough to keep many cores evenly busy.
+    constexpr uint32_t PARALLEL_COUNT_PREFIX_COLUMNS = 3U;
+
+    // Subtree of the backtracking below a fixed placement of the first columns.
+    // The weight is 2 for subtrees of the upper half of the first column, which
+    // stand for their mirrored twins as well, and 1 for the middle row.
+    struct CountSubtask {
+        BacktrackingState state;
+        uint64_t weight;
+    };
+
+    // Counts every solution of a board size on a thread pool. The tree is split
+    // into subtasks by fixing the first columns, and every worker claims the next
+    // unclaimed subtask until none are left, so a worker done with small subtrees
+    // takes over the rest of the queue. Workers count into a slot of their own,
+    // which are summed once all of them are done.
+    class ParallelSolutionsCounter
+    {
+    private:
+        // Own cache line per worker, so the counting does not bounce lines between cores.
+        struct alignas(64) WorkerCount {
+            uint64_t solutionsCount = 0;
+            uint64_t nodesCount = 0;
+            bool stopped = false;
+        };
+
+        std::shared_ptr<ThreadPool> threadPool;
+
+    public:
+        explicit ParallelSolutionsCounter(size_t threadsCount = ThreadPool::DefaultThreadsCount())
+            : threadPool(std::make_shared<ThreadPool>(threadsCount))
+        {}
+
+        size_t ThreadsCount() const { return threadPool->ThreadsCount(); }
+
+        // Same result as Backtracking::CountSolutions, nodes of the fixed columns included.
+        SolutionsCount Count(uint32_t size, const SolveContext& context)
+        {
+            auto startTime = HighResClock::now();
+            SolutionsCount result{};
+
+            if (size == 0 || size > MAX_BACKTRACKING_SIZE)
+                return result;
+
+            TraceSpan countSpan("Parallel count", "count");
+
+            uint32_t prefixColumns = std::min(PARALLEL_COUNT_PREFIX_COLUMNS, size);
+            uint64_t boardMask = size >= 64 ? UINT64_MAX : (1ULL << size) - 1;
+
+            std::vector<CountSubtask> subtasks{};
+            std::vector<WorkerCount> workersCounts(threadPool->ThreadsCount());
+            std::atomic<size_t> nextSubtask{ 0 };
+
+            Backtracking::DispatchFigure(context.figure, [&](auto figure) {
+                constexpr FigureKind F = decltype(figure)::value;
+
+                for (uint32_t row = 0; row < (size + 1) / 2; row++) {
+                    uint64_t rowBit = 1ULL << row;
+                    uint64_t weight = row * 2 + 1 == size ? 1 : 2;
+
+                    result.nodesCount += AddSubtasks<F>(BacktrackingState{}.Place(rowBit, boardMask), 1, prefixColumns, weight, boardMask, subtasks) + 1;
+                }
+
+                threadPool->ParallelFor(workersCounts.size(), [&](size_t worker) {
+                    TraceSpan workerSpan("Count worker", "count");
+
+                    WorkerCount& count = workersCounts[worker];
+                    BacktrackingWalk walk(size, context);
+                    size_t index;
+
+                    while (!walk.stopped && (index = nextSubtask.fetch_add(1, std::memory_order_relaxed)) < subtasks.size()) {
+                        const CountSubtask& subtask = subtasks[index];
+                        count.solutionsCount += subtask.weight * walk.CountCompletions<F>(subtask.state, prefixColumns);
+                    }
+
+                    count.nodesCount = walk.nodesCount;
+                    count.stopped = walk.stopped;
+                });
+            });
+
+            for (auto& count : workersCounts) {
+                result.solutionsCount += count.solutionsCount;
+                result.nodesCount += count.nodesCount;
+                result.timedOut = result.timedOut || count.stopped;
+            }
+
+            result.duration = Solver::TakeTimeStamp(startTime);
+            return result;
+        }
+
+    private:
+        // Appends the placements of the columns from col up to prefixColumns
+        // that complete the state, and returns the amount of visited nodes.
+        template<FigureKind F>
+        static uint64_t AddSubtasks(
+            const BacktrackingState& state,
+            uint32_t col,
+            uint32_t prefixColumns,
+            uint64_t weight,
+            uint64_t boardMask,
+            std::vector<CountSubtask>& subtasks
+        ) {
+            if (col == prefixColumns) {
+                subtasks.push_back({ state, weight });
+                return 0;
+            }
+
+            uint64_t freeRows = state.FreeRows<F>(boardMask);
+            uint64_t nodesCount = 0;
+
+            while (freeRows != 0) {
+                uint64_t rowBit = freeRows & (0 - freeRows);
+                freeRows ^= rowBit;
+
+                nodesCount += AddSubtasks<F>(state.Place(rowBit, boardMask), col + 1, prefixColumns, weight, boardMask, subtasks) + 1;
+            }
+
+            return nodesCount;
+        }
+    };
+}
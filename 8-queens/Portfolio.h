@@ -0,0 +1,97 @@
+#pragma once
+#include "Solver.h"
+#include "ThreadPool.h"
+#include "Random.h"
+#include <atomic>
+
+
+namespace ntf {
+	constexpr size_t NO_PORTFOLIO_WINNER = SIZE_MAX;
+
+	// Races independent solvers on the same board, each on its own thread and with
+	// its own param. The first member to find a solution cancels the others, which
+	// cuts the failure rate and the tail of the durations of randomised searches.
+	// Members are seeded apart, but which of them wins depends on the scheduling.
+	// Every member runs with its own configured param, the param given to the
+	// portfolio has no effect.
+	class Portfolio : public Solver
+	{
+	private:
+		std::vector<std::shared_ptr<Solver>> members;
+		std::shared_ptr<ThreadPool> threadPool;
+
+	public:
+		using Solver::Solve;
+
+		Portfolio(const std::vector<std::shared_ptr<Solver>>& members)
+			: Solver("Portfolio", SolverParam{}), members(members), threadPool(std::make_shared<ThreadPool>(members.size()))
+		{}
+
+		// States and moves counts and stats are summed over all members, including the cancelled ones.
+		Solution Solve(
+			const Board& figuresPositions,
+			const SolverParam& /*param*/,
+			const std::shared_ptr<Heuristic> heuristic,
+			const SolveContext& context
+		) override
+		{
+			auto startTime = HighResClock::now();
+
+			SolveContext membersContext = context.CreateLinked();
+			std::vector<Solution> solutions(members.size());
+			std::atomic<size_t> winnerIndex{ NO_PORTFOLIO_WINNER };
+
+			threadPool->ParallelFor(members.size(), [&](size_t i) {
+				TraceSpan memberSpan("Portfolio member");
+
+				SolveContext memberContext = membersContext;
+				memberContext.seed = DeriveSeed(context.seed, i);
+
+				solutions[i] = members[i]->Solve(figuresPositions, members[i]->param, heuristic, memberContext);
+
+				if (!solutions[i].IsSolved())
+					return;
+
+				size_t noWinner = NO_PORTFOLIO_WINNER;
+
+				if (winnerIndex.compare_exchange_strong(noWinner, i))
+					membersContext.cancellation.Cancel();
+			});
+
+			Solution solution{};
+			uint32_t bestValue = UINT32_MAX;
+
+			for (auto& memberSolution : solutions) {
+				solution.generatedStatesCount += memberSolution.generatedStatesCount;
+				solution.movesCount += memberSolution.movesCount;
+				solution.stats += memberSolution.stats;
+
+				// Without a winner the best of the boards the members were stopped on is kept.
+				if (!memberSolution.timedOut || memberSolution.figuresPositions.Empty())
+					continue;
+
+				uint32_t value = heuristic->EvaluateBoard(memberSolution.figuresPositions, context.figure);
+
+				if (value < bestValue) {
+					bestValue = value;
+					solution.figuresPositions = memberSolution.figuresPositions;
+					solution.timedOut = true;
+				}
+			}
+
+			size_t winner = winnerIndex.load();
+
+			if (winner != NO_PORTFOLIO_WINNER) {
+				solution.figuresPositions = std::move(solutions[winner].figuresPositions);
+				solution.timedOut = false;
+				solution.solverName = members[winner]->name;
+
+				if (members[winner]->param.isUsed)
+					solution.solverName += " (" + members[winner]->param.name + ": " + std::to_string(members[winner]->param.value) + ")";
+			}
+
+			solution.duration = TakeTimeStamp(startTime);
+			return solution;
+		}
+	};
+}
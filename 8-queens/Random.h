@@ -0,0 +1,43 @@
+#pragma once
+#include "Board.h"
+#include <cstdint>
+#include <random>
+
+
+namespace ntf {
+
+    // splitmix64 finalizer, a cheap bijective mix of 64-bit values.
+    inline uint64_t SplitMix64(uint64_t value)
+    {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+
+        return value ^ (value >> 31);
+    }
+
+    // Seed of an independent stream derived from a base seed, e.g. one per test iteration.
+    inline uint64_t DeriveSeed(uint64_t seed, uint64_t stream)
+    {
+        return SplitMix64(seed + 0x9E3779B97F4A7C15ULL * (stream + 1));
+    }
+
+    // Board with a random row in every column, the same for the same size and seed.
+    inline Board RandomBoard(uint32_t size, uint64_t seed)
+    {
+        std::mt19937_64 randomEngine(seed);
+        std::uniform_int_distribution<uint32_t> distribution(0, size - 1);
+        Board figuresPositions(size);
+
+        for (uint32_t col = 0; col < size; col++)
+            figuresPositions.SetRow(col, distribution(randomEngine));
+
+        return figuresPositions;
+    }
+
+    // Seed of the solver run on the board generated from boardSeed, kept apart
+    // from the stream of the board itself.
+    inline uint64_t SolverSeed(uint64_t boardSeed)
+    {
+        return DeriveSeed(boardSeed, 0);
+    }
+}
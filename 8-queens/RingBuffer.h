@@ -0,0 +1,70 @@
+#pragma once
+#include <algorithm>
+#include <array>
+
+
+namespace ntf {
+
+    // Keeps the last N pushed values in a fixed array, so recording a value every
+    // frame never allocates. Index 0 is the oldest of the kept values.
+    template<typename T, size_t N>
+    class RingBuffer
+    {
+    private:
+        std::array<T, N> items;
+        size_t next;
+        size_t count;
+
+    public:
+        RingBuffer() : items{}, next(0), count(0) {}
+
+        void Push(const T& item)
+        {
+            items[next] = item;
+            next = (next + 1) % N;
+            count = std::min(count + 1, N);
+        }
+
+        void Clear()
+        {
+            next = 0;
+            count = 0;
+        }
+
+        size_t Size() const { return count; }
+
+        bool Empty() const { return count == 0; }
+
+        static constexpr size_t Capacity() { return N; }
+
+        const T& operator [] (size_t index) const
+        {
+            return items[(next + N - count + index) % N];
+        }
+
+        const T& Last() const
+        {
+            return items[(next + N - 1) % N];
+        }
+
+        T Max() const
+        {
+            T max{};
+
+            for (size_t i = 0; i < count; i++)
+                max = std::max(max, items[i]);
+
+            return max;
+        }
+
+        T Average() const
+        {
+            T sum{};
+
+            for (size_t i = 0; i < count; i++)
+                sum += items[i];
+
+            return count == 0 ? sum : sum / static_cast<T>(count);
+        }
+    };
+}
@@ -0,0 +1,486 @@
+#pragma once
+#include "AttackTable.h"
+#include "Board.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace ntf {
+    constexpr uint32_t MAX_SOLUTIONS_FILE_SIZE = 64U;
+    constexpr size_t SOLUTIONS_BUFFER_SIZE = 1U << 20;
+
+    // Full buffers waiting for the disk. Enumeration only waits once this many
+    // are queued, that is when the disk cannot keep up with it at all.
+    constexpr size_t SOLUTIONS_PENDING_BUFFERS = 16U;
+
+    constexpr uint8_t SOLUTIONS_FILE_MAGIC[4] = { 'N', 'T', 'F', 'S' };
+    constexpr uint8_t SOLUTIONS_FILE_VERSION = 1U;
+    constexpr size_t SOLUTIONS_HEADER_SIZE = 8U;
+
+    // PACKED stores every solution as its rows of ceil(log2 N) bits each, padded
+    // to whole bytes. DELTA relies on the lexicographic order of the solutions:
+    // after the first solution, stored packed, a record is the amount of leading
+    // rows shared with the previous solution and how far past the previous row
+    // the first differing row is, both as varints, followed by the remaining rows
+    // packed. Consecutive solutions mostly differ in their last columns only.
+    enum class SolutionsEncoding : uint8_t { PACKED, DELTA };
+
+    inline const char* SolutionsEncodingName(SolutionsEncoding encoding)
+    {
+        return encoding == SolutionsEncoding::PACKED ? "packed" : "delta";
+    }
+
+    inline bool ParseSolutionsEncoding(const std::string& name, SolutionsEncoding& encoding)
+    {
+        if (name == "packed")
+            encoding = SolutionsEncoding::PACKED;
+        else if (name == "delta")
+            encoding = SolutionsEncoding::DELTA;
+        else
+            return false;
+
+        return true;
+    }
+
+    inline uint32_t PackedRowBits(uint32_t size)
+    {
+        uint32_t bits = 1;
+
+        while (bits < 32 && (1ULL << bits) < size)
+            bits++;
+
+        return bits;
+    }
+
+    // Appends solutions of one board size to a file. Solutions are encoded into
+    // a buffer in memory, and full buffers are handed over to a thread of the
+    // writer, which writes them out while the caller goes on. Written buffers are
+    // reused, so the memory stays bounded however many solutions there are.
+    class SolutionsWriter
+    {
+    private:
+        std::FILE* file;
+        SolutionsEncoding encoding;
+        uint32_t size;
+        uint32_t rowBits;
+        uint64_t solutionsCount;
+        uint64_t bytesCount;
+
+        std::vector<uint8_t> buffer;
+        std::array<uint8_t, MAX_SOLUTIONS_FILE_SIZE> previousRows;
+
+        std::thread writerThread;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<std::vector<uint8_t>> pendingBuffers;
+        std::vector<std::vector<uint8_t>> freeBuffers;
+        bool closing;
+        bool failed;
+
+    public:
+        SolutionsWriter()
+            : file(nullptr), encoding(SolutionsEncoding::DELTA), size(0), rowBits(0), solutionsCount(0), bytesCount(0),
+            buffer{}, previousRows{}, writerThread{}, pendingBuffers{}, freeBuffers{}, closing(false), failed(false)
+        {}
+
+        SolutionsWriter(const SolutionsWriter&) = delete;
+        SolutionsWriter& operator = (const SolutionsWriter&) = delete;
+
+        ~SolutionsWriter()
+        {
+            Close();
+        }
+
+        // Creates the file and writes its header. Boards up to 64 x 64 only.
+        bool Open(const std::string& path, SolutionsEncoding encoding, FigureKind figure, uint32_t size)
+        {
+            if (file != nullptr || size == 0 || size > MAX_SOLUTIONS_FILE_SIZE)
+                return false;
+
+            file = std::fopen(path.c_str(), "wb");
+
+            if (file == nullptr)
+                return false;
+
+            this->encoding = encoding;
+            this->size = size;
+            rowBits = PackedRowBits(size);
+            solutionsCount = 0;
+            bytesCount = 0;
+            previousRows.fill(0);
+            closing = false;
+            failed = false;
+
+            buffer.clear();
+            buffer.reserve(SOLUTIONS_BUFFER_SIZE);
+            buffer.insert(buffer.end(), std::begin(SOLUTIONS_FILE_MAGIC), std::end(SOLUTIONS_FILE_MAGIC));
+            buffer.push_back(SOLUTIONS_FILE_VERSION);
+            buffer.push_back(static_cast<uint8_t>(encoding));
+            buffer.push_back(static_cast<uint8_t>(figure));
+            buffer.push_back(static_cast<uint8_t>(size));
+
+            writerThread = std::thread([this]() { WriteBuffers(); });
+            return true;
+        }
+
+        // Returns false and writes nothing for a board of another size, or with
+        // DELTA for one not following the previous solution in lexicographic order.
+        bool Write(const Board& solution)
+        {
+            bool written = solution.Size() == size
+                && (encoding == SolutionsEncoding::PACKED ? WritePacked(solution, 0) : WriteDelta(solution));
+
+            assert(written && "Solutions must match the file size and, for DELTA, be strictly increasing");
+
+            if (!written)
+                return false;
+
+            for (uint32_t col = 0; col < size; col++)
+                previousRows[col] = static_cast<uint8_t>(solution.Row(col));
+
+            solutionsCount++;
+
+            // A record takes a byte per row at most, plus the varints of DELTA.
+            if (buffer.size() + size + 8 > SOLUTIONS_BUFFER_SIZE)
+                Flush();
+
+            return true;
+        }
+
+        // Waits for the buffers to be written and closes the file. Returns false
+        // if any of the writes failed.
+        bool Close()
+        {
+            if (file == nullptr)
+                return false;
+
+            Flush();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closing = true;
+            }
+
+            changed.notify_all();
+            writerThread.join();
+
+            bool closed = std::fclose(file) == 0;
+            file = nullptr;
+
+            return closed && !failed;
+        }
+
+        uint64_t SolutionsCount() const { return solutionsCount; }
+
+        // Bytes of the file, header included, once it is closed.
+        uint64_t BytesCount() const { return bytesCount; }
+
+    private:
+        bool WritePacked(const Board& solution, uint32_t firstCol)
+        {
+            uint64_t bits = 0;
+            uint32_t bitsCount = 0;
+
+            for (uint32_t col = firstCol; col < size; col++) {
+                bits |= static_cast<uint64_t>(solution.Row(col)) << bitsCount;
+                bitsCount += rowBits;
+
+                while (bitsCount >= 8) {
+                    buffer.push_back(static_cast<uint8_t>(bits));
+                    bits >>= 8;
+                    bitsCount -= 8;
+                }
+            }
+
+            if (bitsCount > 0)
+                buffer.push_back(static_cast<uint8_t>(bits));
+
+            return true;
+        }
+
+        bool WriteDelta(const Board& solution)
+        {
+            if (solutionsCount == 0)
+                return WritePacked(solution, 0);
+
+            uint32_t prefix = 0;
+
+            while (prefix < size && solution.Row(prefix) == previousRows[prefix])
+                prefix++;
+
+            if (prefix == size || solution.Row(prefix) < previousRows[prefix])
+                return false;
+
+            WriteVarint(prefix);
+            WriteVarint(solution.Row(prefix) - previousRows[prefix] - 1);
+            return WritePacked(solution, prefix + 1);
+        }
+
+        void WriteVarint(uint32_t value)
+        {
+            while (value >= 0x80) {
+                buffer.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+
+            buffer.push_back(static_cast<uint8_t>(value));
+        }
+
+        // Queues the current buffer for the writer thread and takes a free one.
+        void Flush()
+        {
+            if (buffer.empty())
+                return;
+
+            bytesCount += buffer.size();
+
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]() { return pendingBuffers.size() < SOLUTIONS_PENDING_BUFFERS; });
+
+            pendingBuffers.push_back(std::move(buffer));
+
+            if (freeBuffers.empty()) {
+                buffer = std::vector<uint8_t>{};
+                buffer.reserve(SOLUTIONS_BUFFER_SIZE);
+            }
+            else {
+                buffer = std::move(freeBuffers.back());
+                freeBuffers.pop_back();
+            }
+
+            lock.unlock();
+            changed.notify_all();
+        }
+
+        void WriteBuffers()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            while (true) {
+                changed.wait(lock, [this]() { return closing || !pendingBuffers.empty(); });
+
+                if (pendingBuffers.empty())
+                    return;
+
+                std::vector<uint8_t> pending = std::move(pendingBuffers.front());
+                pendingBuffers.pop_front();
+                lock.unlock();
+
+                bool written = failed || std::fwrite(pending.data(), 1, pending.size(), file) == pending.size();
+                pending.clear();
+
+                lock.lock();
+                failed = failed || !written;
+                freeBuffers.push_back(std::move(pending));
+                changed.notify_all();
+            }
+        }
+    };
+
+    // Reads the solutions of a file of SolutionsWriter one by one, through a
+    // buffer of its own, so the file is never loaded as a whole.
+    class SolutionsReader
+    {
+    private:
+        std::FILE* file;
+        SolutionsEncoding encoding;
+        FigureKind figure;
+        uint32_t size;
+        uint32_t rowBits;
+        uint64_t solutionsCount;
+        uint64_t bytesCount;
+
+        std::vector<uint8_t> buffer;
+        size_t position;
+        std::array<uint8_t, MAX_SOLUTIONS_FILE_SIZE> previousRows;
+        bool failed;
+
+    public:
+        SolutionsReader()
+            : file(nullptr), encoding(SolutionsEncoding::DELTA), figure(FigureKind::QUEEN), size(0), rowBits(0),
+            solutionsCount(0), bytesCount(0), buffer{}, position(0), previousRows{}, failed(false)
+        {}
+
+        SolutionsReader(const SolutionsReader&) = delete;
+        SolutionsReader& operator = (const SolutionsReader&) = delete;
+
+        ~SolutionsReader()
+        {
+            if (file != nullptr)
+                std::fclose(file);
+        }
+
+        // Opens the file and checks its header.
+        bool Open(const std::string& path)
+        {
+            if (file != nullptr)
+                return false;
+
+            file = std::fopen(path.c_str(), "rb");
+
+            if (file == nullptr)
+                return false;
+
+            buffer.reserve(SOLUTIONS_BUFFER_SIZE);
+            uint8_t header[SOLUTIONS_HEADER_SIZE];
+
+            for (uint8_t& byte : header) {
+                if (!ReadByte(byte))
+                    return false;
+            }
+
+            bool valid = std::equal(std::begin(SOLUTIONS_FILE_MAGIC), std::end(SOLUTIONS_FILE_MAGIC), header)
+                && header[4] == SOLUTIONS_FILE_VERSION
+                && header[5] <= static_cast<uint8_t>(SolutionsEncoding::DELTA)
+                && header[6] < FIGURE_KINDS_COUNT
+                && header[7] > 0 && header[7] <= MAX_SOLUTIONS_FILE_SIZE;
+
+            if (!valid)
+                return false;
+
+            encoding = static_cast<SolutionsEncoding>(header[5]);
+            figure = static_cast<FigureKind>(header[6]);
+            size = header[7];
+            rowBits = PackedRowBits(size);
+            return true;
+        }
+
+        // Reads the next solution. Returns false at the end of the file, or on a
+        // malformed record, after which Failed() is true.
+        bool Next(Board& solution)
+        {
+            if (failed || file == nullptr || AtEnd())
+                return false;
+
+            if (solution.Size() != size)
+                solution = Board(size);
+
+            bool decoded = encoding == SolutionsEncoding::PACKED || solutionsCount == 0
+                ? ReadPacked(solution, 0)
+                : ReadDelta(solution);
+
+            if (!decoded) {
+                failed = true;
+                return false;
+            }
+
+            for (uint32_t col = 0; col < size; col++)
+                previousRows[col] = static_cast<uint8_t>(solution.Row(col));
+
+            solutionsCount++;
+            return true;
+        }
+
+        bool Failed() const { return failed; }
+
+        SolutionsEncoding Encoding() const { return encoding; }
+
+        FigureKind Figure() const { return figure; }
+
+        uint32_t Size() const { return size; }
+
+        uint64_t SolutionsCount() const { return solutionsCount; }
+
+        uint64_t BytesCount() const { return bytesCount; }
+
+    private:
+        bool AtEnd()
+        {
+            if (position == buffer.size()) {
+                buffer.resize(SOLUTIONS_BUFFER_SIZE);
+                buffer.resize(std::fread(buffer.data(), 1, SOLUTIONS_BUFFER_SIZE, file));
+                position = 0;
+            }
+
+            return buffer.empty();
+        }
+
+        bool ReadByte(uint8_t& byte)
+        {
+            if (AtEnd())
+                return false;
+
+            byte = buffer[position++];
+            bytesCount++;
+            return true;
+        }
+
+        bool ReadPacked(Board& solution, uint32_t firstCol)
+        {
+            uint64_t bits = 0;
+            uint32_t bitsCount = 0;
+            uint64_t rowMask = (1ULL << rowBits) - 1;
+
+            for (uint32_t col = firstCol; col < size; col++) {
+                while (bitsCount < rowBits) {
+                    uint8_t byte;
+
+                    if (!ReadByte(byte))
+                        return false;
+
+                    bits |= static_cast<uint64_t>(byte) << bitsCount;
+                    bitsCount += 8;
+                }
+
+                uint32_t row = static_cast<uint32_t>(bits & rowMask);
+
+                if (row >= size)
+                    return false;
+
+                solution.SetRow(col, row);
+                bits >>= rowBits;
+                bitsCount -= rowBits;
+            }
+
+            return true;
+        }
+
+        bool ReadDelta(Board& solution)
+        {
+            uint32_t prefix;
+            uint32_t distance;
+
+            if (!ReadVarint(prefix) || prefix >= size || !ReadVarint(distance))
+                return false;
+
+            uint32_t row = previousRows[prefix] + 1 + distance;
+
+            if (distance >= size || row >= size)
+                return false;
+
+            for (uint32_t col = 0; col < prefix; col++)
+                solution.SetRow(col, previousRows[col]);
+
+            solution.SetRow(prefix, row);
+
+            return ReadPacked(solution, prefix + 1);
+        }
+
+        bool ReadVarint(uint32_t& value)
+        {
+            uint8_t byte;
+            value = 0;
+
+            for (uint32_t shift = 0; shift < 35; shift += 7) {
+                if (!ReadByte(byte))
+                    return false;
+
+                value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+
+                if ((byte & 0x80) == 0)
+                    return true;
+            }
+
+            return false;
+        }
+    };
+}
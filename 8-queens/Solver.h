@@ -1,6 +1,11 @@
 #pragma once
-#include "olcPixelGameEngine.h"
 #include "Heuristic.h"
+#include "Zobrist.h"
+#include "CancellationToken.h"
+#include "SolverStats.h"
+#include "Trace.h"
+#include <atomic>
+#include <chrono>
 #include <queue>
 
 
@@ -10,29 +15,24 @@ namespace ntf {
     using TimePoint = std::chrono::high_resolution_clock::time_point;
     using Microseconds = std::chrono::microseconds;
 
+    constexpr uint64_t UNLIMITED_ITERATIONS = UINT64_MAX;
+
     struct SearchState {
-        std::vector<olc::vi2d> figuresPositions;
-        uint32_t heuristicValue;
+        Board figuresPositions;
+        uint32_t heuristicValue = 0;
+        uint64_t hash = 0;
 
         SearchState() = default;
-        SearchState(const std::vector<olc::vi2d>& figuresPositions, uint32_t heuristicValue)
-            : figuresPositions(figuresPositions), heuristicValue(heuristicValue)
+        SearchState(const Board& figuresPositions, uint32_t heuristicValue)
+            : figuresPositions(figuresPositions), heuristicValue(heuristicValue), hash(ZobristHash(figuresPositions))
         {}
 
-        SearchState(std::vector<olc::vi2d>&& figuresPositions, uint32_t heuristicValue)
-            : figuresPositions(std::move(figuresPositions)), heuristicValue(heuristicValue)
+        SearchState(Board&& figuresPositions, uint32_t heuristicValue, uint64_t hash)
+            : figuresPositions(std::move(figuresPositions)), heuristicValue(heuristicValue), hash(hash)
         {}
 
         bool operator == (const SearchState& other) const {
-            if (figuresPositions.size() != other.figuresPositions.size())
-                return false;
-
-            for (size_t i = 0; i < figuresPositions.size(); i++) {
-                if (figuresPositions[i] != other.figuresPositions[i])
-                    return false;
-            }
-            
-            return heuristicValue == other.heuristicValue;
+            return hash == other.hash && figuresPositions == other.figuresPositions && heuristicValue == other.heuristicValue;
         }
 
         bool operator < (const SearchState& other) const {
@@ -42,32 +42,14 @@ namespace ntf {
         bool operator > (const SearchState& other) const {
             return heuristicValue > other.heuristicValue;
         }
-
-        std::string Serialize()
-        {
-            std::string serial = "";
-
-            for (auto& position : figuresPositions)
-                serial += "[" + std::to_string(position.x) + ";" + std::to_string(position.y) + "]";
-            
-            return serial;
-        }
     };
 
     struct SearchHeuristicValue {
-        std::vector<olc::vi2d> figuresPositions;
+        Board figuresPositions;
         HeuristicValue heuristicValue;
 
         bool operator == (const SearchHeuristicValue& other) const {
-            if (figuresPositions.size() != other.figuresPositions.size())
-                return false;
-
-            for (size_t i = 0; i < figuresPositions.size(); i++) {
-                if (figuresPositions[i] != other.figuresPositions[i])
-                    return false;
-            }
-
-            return heuristicValue == other.heuristicValue;
+            return figuresPositions == other.figuresPositions && heuristicValue == other.heuristicValue;
         }
 
         bool operator < (const SearchHeuristicValue& other) const {
@@ -83,21 +65,38 @@ namespace ntf {
     using SearchHeuristicValuesQueue = std::priority_queue<SearchHeuristicValue, std::vector<SearchHeuristicValue>, std::greater<SearchHeuristicValue>>;
 
     struct Solution {
-        std::vector<olc::vi2d> figuresPositions;
+        Board figuresPositions;
         Microseconds duration = std::chrono::microseconds::zero();
 
-        int generatedStatesCount;
+        uint64_t generatedStatesCount = 0;
+        uint64_t movesCount = 0;
 
-        bool operator == (const Solution& other) const {
-            if (figuresPositions.size() != other.figuresPositions.size())
-                return false;
+        // Name of the solver that found the board, set by solvers that delegate to others.
+        std::string solverName;
+
+        // Set when the search was stopped by its context. The board is then the
+        // best one found so far and is not a solution.
+        bool timedOut = false;
 
-            for (size_t i = 0; i < figuresPositions.size(); i++) {
-                if (figuresPositions[i] != other.figuresPositions[i])
-                    return false;
-            }
+        SolverStats stats;
+
+        bool IsSolved() const {
+            return !timedOut && !figuresPositions.Empty();
+        }
+
+        bool operator == (const Solution& other) const {
+            return figuresPositions == other.figuresPositions
+                && duration == other.duration
+                && generatedStatesCount == other.generatedStatesCount
+                && movesCount == other.movesCount
+                && solverName == other.solverName
+                && timedOut == other.timedOut;
+        }
 
-            return duration == other.duration && generatedStatesCount == generatedStatesCount;
+        double MovesPerSecond() const {
+            if (duration.count() == 0)
+                return 0.0;
+            return static_cast<double>(movesCount) * 1e6 / static_cast<double>(duration.count());
         }
     };
 
@@ -110,6 +109,65 @@ namespace ntf {
         int32_t value = 0;
     };
 
+    // Live progress of a solve that runs on another thread. Members of a portfolio
+    // share it, so the iterations count only grows and the best value only drops.
+    struct SolveProgress {
+        std::atomic<uint64_t> iterationsCount{ 0 };
+        std::atomic<uint32_t> bestHeuristicValue{ UINT32_MAX };
+
+        void Report(uint64_t iterationsCount, uint32_t bestHeuristicValue) {
+            uint64_t currentIterations = this->iterationsCount.load(std::memory_order_relaxed);
+            uint32_t currentBest = this->bestHeuristicValue.load(std::memory_order_relaxed);
+
+            while (currentIterations < iterationsCount
+                && !this->iterationsCount.compare_exchange_weak(currentIterations, iterationsCount, std::memory_order_relaxed));
+
+            while (currentBest > bestHeuristicValue
+                && !this->bestHeuristicValue.compare_exchange_weak(currentBest, bestHeuristicValue, std::memory_order_relaxed));
+        }
+    };
+
+    // Limits of a single solve. Solvers poll ShouldStop once per iteration of their
+    // main loop (a beam generation, a tabu iteration, a min-conflicts step).
+    struct SolveContext {
+        CancellationToken cancellation;
+        TimePoint deadline = TimePoint::max();
+        uint64_t iterationsBudget = UNLIMITED_ITERATIONS;
+        std::shared_ptr<SolveProgress> progress;
+
+        // Figure placed on the board, whose threats the solver has to remove.
+        FigureKind figure = FigureKind::QUEEN;
+
+        // Seed of the random choices of the solver. The same board, param and seed
+        // give the same search, so a slow or failed run can be replayed.
+        uint64_t seed = 0;
+
+        static SolveContext WithTimeout(Microseconds timeout) {
+            SolveContext context{};
+            context.deadline = HighResClock::now() + timeout;
+            return context;
+        }
+
+        // Child context with the same limits, which can be cancelled without cancelling this one.
+        SolveContext CreateLinked() const {
+            SolveContext linked(*this);
+            linked.cancellation = cancellation.CreateLinked();
+            return linked;
+        }
+
+        // Iterations of cheap loops can read the clock only every clockPeriod iterations.
+        bool ShouldStop(uint64_t iteration, uint64_t clockPeriod = 1) const {
+            if (iteration >= iterationsBudget || cancellation.IsCancelled())
+                return true;
+            return deadline != TimePoint::max() && iteration % clockPeriod == 0 && HighResClock::now() >= deadline;
+        }
+
+        void ReportProgress(uint64_t iterationsCount, uint32_t bestHeuristicValue) const {
+            if (progress)
+                progress->Report(iterationsCount, bestHeuristicValue);
+        }
+    };
+
     class Solver : public std::enable_shared_from_this<Solver>
     {
     public:
@@ -126,22 +184,92 @@ namespace ntf {
             return std::chrono::duration_cast<Microseconds>(HighResClock::now() - startTime);
         };
 
+        static Solution Solved(Board figuresPositions, TimePoint startTime, uint64_t generatedStatesCount, uint64_t movesCount = 0) {
+            Solution solution{};
+            solution.figuresPositions = std::move(figuresPositions);
+            solution.duration = TakeTimeStamp(startTime);
+            solution.generatedStatesCount = generatedStatesCount;
+            solution.movesCount = movesCount;
+            return solution;
+        }
+
+        // Search that ended without a solution, the board is left empty.
+        static Solution Unsolved(TimePoint startTime, uint64_t generatedStatesCount, uint64_t movesCount = 0) {
+            return Solved({}, startTime, generatedStatesCount, movesCount);
+        }
+
+        static Solution TimedOut(Board bestPositions, TimePoint startTime, uint64_t generatedStatesCount, uint64_t movesCount = 0) {
+            Solution solution = Solved(std::move(bestPositions), startTime, generatedStatesCount, movesCount);
+            solution.timedOut = true;
+            return solution;
+        }
+
+        template<typename Counters>
         static SearchState GenerateState(
-            const std::vector<olc::vi2d>& figuresPositions,
-            const olc::vi2d& movePosition,
+            const Counters& counters,
+            uint64_t hash,
+            const Square& movePosition,
             const std::shared_ptr<Heuristic> heuristic
         ) {
-            std::vector<olc::vi2d> newPositions(figuresPositions);
-            newPositions[movePosition.x].y = movePosition.y;
+            Board newPositions(counters.Positions());
+            newPositions.SetRow(movePosition.x, movePosition.y);
+
+            uint32_t newStateHeuristicValue = heuristic->EvaluateMove(counters, movePosition.x, movePosition.y);
+            uint64_t newStateHash = ZobristMove(hash, movePosition.x, counters.Positions().Row(movePosition.x), movePosition.y);
 
-            uint32_t newStateHeuristicValue = heuristic->EvaluateBoard(newPositions);
-            return { newPositions, newStateHeuristicValue };
+            return { std::move(newPositions), newStateHeuristicValue, newStateHash };
         };
 
-        virtual Solution Solve(
-            const std::vector<olc::vi2d>& figuresPositions,
+        template<uint32_t N>
+        using BoardSize = std::integral_constant<uint32_t, N>;
+
+        // Calls the callback with BoardSize<N> of the board when N is in the static
+        // range, so solvers run on counters specialised for it, and with
+        // BoardSize<DYNAMIC_BOARD_SIZE> otherwise.
+        template<typename Callback>
+        static auto DispatchBoardSize(uint32_t size, Callback&& callback)
+        {
+            return DispatchBoardSize(size, callback, std::make_integer_sequence<uint32_t, STATIC_BOARD_SIZES_COUNT>{});
+        }
+
+        Solution Solve(
+            const Board& figuresPositions,
             const SolverParam& param,
             const std::shared_ptr<Heuristic> heuristic
+        ) {
+            return Solve(figuresPositions, param, heuristic, SolveContext{});
+        }
+
+        // Returns an empty board when the search fails, and the best board found
+        // so far flagged as timed out when the context stops it.
+        virtual Solution Solve(
+            const Board& figuresPositions,
+            const SolverParam& param,
+            const std::shared_ptr<Heuristic> heuristic,
+            const SolveContext& context
         ) = 0;
+
+        // Largest board the solver can search, larger ones come back unsolved.
+        virtual uint32_t MaxBoardSize() const { return UINT32_MAX; }
+
+    private:
+        template<typename Callback, uint32_t... Offsets>
+        static auto DispatchBoardSize(uint32_t size, Callback& callback, std::integer_sequence<uint32_t, Offsets...>)
+        {
+            using Result = decltype(callback(BoardSize<DYNAMIC_BOARD_SIZE>{}));
+            using Entry = Result(*)(Callback&);
+
+            static constexpr Entry table[] = { &InvokeSized<MIN_STATIC_BOARD_SIZE + Offsets, Callback, Result>... };
+
+            if (IsStaticBoardSize(size))
+                return table[size - MIN_STATIC_BOARD_SIZE](callback);
+            return callback(BoardSize<DYNAMIC_BOARD_SIZE>{});
+        }
+
+        template<uint32_t N, typename Callback, typename Result>
+        static Result InvokeSized(Callback& callback)
+        {
+            return callback(BoardSize<N>{});
+        }
     };
 }
\ No newline at end of file
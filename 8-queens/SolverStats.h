@@ -0,0 +1,101 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+// Builds with NTF_SOLVER_STATS defined to 1 count what the solvers do on their
+// hot paths. Otherwise the counting calls are empty and compile to nothing.
+#ifndef NTF_SOLVER_STATS
+#define NTF_SOLVER_STATS 0
+#endif
+
+
+namespace ntf {
+    constexpr bool SOLVER_STATS_ENABLED = NTF_SOLVER_STATS != 0;
+
+    // Hot path counters of a solve, all zeros unless stats are enabled. The
+    // frontier is the beam, the queue or the worklist, depending on the solver.
+    struct SolverStats {
+        uint64_t iterationsCount = 0;
+        uint64_t heuristicEvaluationsCount = 0;
+        uint64_t visitedLookupsCount = 0;
+        uint64_t visitedHitsCount = 0;
+        uint64_t duplicatesCount = 0;
+        uint64_t queuePushesCount = 0;
+        uint64_t queuePopsCount = 0;
+        uint64_t peakFrontierSize = 0;
+
+        SolverStats& operator += (const SolverStats& other) {
+            iterationsCount += other.iterationsCount;
+            heuristicEvaluationsCount += other.heuristicEvaluationsCount;
+            visitedLookupsCount += other.visitedLookupsCount;
+            visitedHitsCount += other.visitedHitsCount;
+            duplicatesCount += other.duplicatesCount;
+            queuePushesCount += other.queuePushesCount;
+            queuePopsCount += other.queuePopsCount;
+            peakFrontierSize = std::max(peakFrontierSize, other.peakFrontierSize);
+            return *this;
+        }
+    };
+
+    // Counting interface of the solvers, one per solve or per worker of a solve.
+    class SolverStatsCounter
+    {
+    private:
+        SolverStats stats;
+
+    public:
+        void CountIteration()
+        {
+            if constexpr (SOLVER_STATS_ENABLED)
+                stats.iterationsCount++;
+        }
+
+        void CountHeuristicEvaluations(uint64_t count = 1)
+        {
+            if constexpr (SOLVER_STATS_ENABLED)
+                stats.heuristicEvaluationsCount += count;
+        }
+
+        // Lookup of a state or move in a visited set or tabu list.
+        void CountVisitedLookup(bool hit)
+        {
+            if constexpr (SOLVER_STATS_ENABLED) {
+                stats.visitedLookupsCount++;
+                stats.visitedHitsCount += hit ? 1 : 0;
+            }
+        }
+
+        // Generated state dropped since an equal one is already in the frontier.
+        void CountDuplicate()
+        {
+            if constexpr (SOLVER_STATS_ENABLED)
+                stats.duplicatesCount++;
+        }
+
+        void CountQueuePushes(uint64_t count = 1)
+        {
+            if constexpr (SOLVER_STATS_ENABLED)
+                stats.queuePushesCount += count;
+        }
+
+        void CountQueuePops(uint64_t count = 1)
+        {
+            if constexpr (SOLVER_STATS_ENABLED)
+                stats.queuePopsCount += count;
+        }
+
+        void CountFrontierSize(uint64_t size)
+        {
+            if constexpr (SOLVER_STATS_ENABLED)
+                stats.peakFrontierSize = std::max(stats.peakFrontierSize, size);
+        }
+
+        void Merge(const SolverStatsCounter& other)
+        {
+            if constexpr (SOLVER_STATS_ENABLED)
+                stats += other.stats;
+        }
+
+        const SolverStats& Stats() const { return stats; }
+    };
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+
+namespace ntf {
+
+    // Column (x) and row (y) of a board square. Kept apart from olc::vi2d, so the
+    // solvers and heuristics do not depend on the rendering engine.
+    struct Square {
+        int32_t x = 0;
+        int32_t y = 0;
+
+        Square() = default;
+        Square(int32_t x, int32_t y) : x(x), y(y) {}
+
+        bool operator == (const Square& other) const {
+            return x == other.x && y == other.y;
+        }
+
+        bool operator != (const Square& other) const {
+            return !(*this == other);
+        }
+    };
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "HashSet.h"
+
+
+namespace ntf {
+
+    // Tabu states keyed by their hashes. Insertion order is kept in a ring buffer,
+    // so once the list is full the oldest entry is released in O(1).
+    class TabuList
+    {
+    private:
+        std::vector<uint64_t> entries;
+        size_t capacity;
+        size_t oldestIndex;
+        HashSet members;
+
+    public:
+        explicit TabuList(size_t capacity) : entries{}, capacity(capacity), oldestIndex(0), members{}
+        {
+            entries.reserve(capacity);
+            members.Reserve(capacity);
+        }
+
+        size_t Size() const { return members.Size(); }
+
+        size_t Capacity() const { return capacity; }
+
+        bool Contains(uint64_t key) const { return members.Contains(key); }
+
+        void Insert(uint64_t key)
+        {
+            if (capacity == 0 || !members.Insert(key))
+                return;
+
+            if (entries.size() < capacity) {
+                entries.push_back(key);
+                return;
+            }
+
+            members.Erase(entries[oldestIndex]);
+            entries[oldestIndex] = key;
+            oldestIndex = (oldestIndex + 1) % capacity;
+        }
+    };
+
+    // Attribute based tabu memory. Instead of whole states it forbids placing the
+    // figure of a column on a row until the given iteration, which can be checked
+    // before the successor state is built.
+    class TabuMoves
+    {
+    private:
+        std::vector<uint64_t> releaseIterations;
+        uint32_t size;
+
+    public:
+        explicit TabuMoves(uint32_t size) : releaseIterations(static_cast<size_t>(size) * size, 0), size(size) {}
+
+        bool IsTabu(uint32_t col, uint32_t row, uint64_t iteration) const
+        {
+            return releaseIterations[static_cast<size_t>(col) * size + row] > iteration;
+        }
+
+        void Forbid(uint32_t col, uint32_t row, uint64_t iteration, uint64_t tenure)
+        {
+            releaseIterations[static_cast<size_t>(col) * size + row] = iteration + tenure;
+        }
+    };
+}
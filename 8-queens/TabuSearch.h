@@ -1,83 +1,248 @@
 #pragma once
 #include "Solver.h"
+#include "TabuList.h"
+#include <random>
 
 
 namespace ntf {
+	constexpr uint64_t TABU_MOVES_ITERATIONS_PER_FIGURE = 1000U;
+
+	enum class TabuMode { STATES, MOVES };
+
 	class TabuSearch : public Solver
 	{
 	public:
-		TabuSearch(const SolverParam& param) : Solver("Tabu Search", param) {}
+		using Solver::Solve;
+
+		TabuMode mode;
+
+		TabuSearch(const SolverParam& param, TabuMode mode = TabuMode::STATES)
+			: Solver(mode == TabuMode::STATES ? "Tabu Search" : "Tabu Search (moves)", param), mode(mode)
+		{}
 
 		Solution Solve(
-			const std::vector<olc::vi2d>& figuresPositions,
+			const Board& figuresPositions,
 			const SolverParam& param,
-			const std::shared_ptr<Heuristic> heuristic
+			const std::shared_ptr<Heuristic> heuristic,
+			const SolveContext& context
 		) override
 		{
+			SolverStatsCounter stats;
+
+			Solution solution = DispatchBoardSize(figuresPositions.Size(), [&](auto size) {
+				return SolveSized<decltype(size)::value>(figuresPositions, param, heuristic, context, stats);
+			});
+
+			solution.stats = stats.Stats();
+			return solution;
+		}
+
+		template<uint32_t N>
+		Solution SolveSized(
+			const Board& figuresPositions,
+			const SolverParam& param,
+			const std::shared_ptr<Heuristic> heuristic,
+			const SolveContext& context,
+			SolverStatsCounter& stats
+		) {
+			if (mode == TabuMode::MOVES)
+				return SolveMoves<N>(figuresPositions, param, heuristic, context, stats);
+			return SolveStates<N>(figuresPositions, param, heuristic, context, stats);
+		}
+
+	private:
+		template<uint32_t N>
+		Solution SolveStates(
+			const Board& figuresPositions,
+			const SolverParam& param,
+			const std::shared_ptr<Heuristic> heuristic,
+			const SolveContext& context,
+			SolverStatsCounter& stats
+		) {
 			auto startTime = HighResClock::now();
-			int generatedStatesCount = 0;
+			uint64_t generatedStatesCount = 0;
 
-			int tabuListMaxSize = param.value;
+			size_t tabuListMaxSize = static_cast<size_t>(std::max(param.value, 0));
 			uint64_t popDepth = 1;
 
 			std::shared_ptr<SearchState> bestFit(std::make_shared<SearchState>(
 				figuresPositions,
-				heuristic->EvaluateBoard(figuresPositions)
+				heuristic->EvaluateBoard(figuresPositions, context.figure)
 			));
 
-			std::unordered_map<std::string, bool> tabuList{ {bestFit->Serialize(), true} };
+			SearchState bestSeen(*bestFit);
+			stats.CountHeuristicEvaluations();
+
+			TabuList tabuList(tabuListMaxSize);
+			tabuList.Insert(bestFit->hash);
 			SearchStatesQueue fitnessQueue;
+			BasicThreatCounters<N> counters(context.figure);
 
 			fitnessQueue.push(*bestFit);
+			stats.CountQueuePushes();
 
-			while (bestFit->heuristicValue != 0 && !fitnessQueue.empty()) {
+			for (uint64_t iteration = 0; bestFit->heuristicValue != 0 && !fitnessQueue.empty(); iteration++) {
 
-				for (auto& position : bestFit->figuresPositions) {
+				context.ReportProgress(iteration, bestSeen.heuristicValue);
 
-					for (auto& result : heuristic->EvaluateColumn(position, bestFit->figuresPositions)) {
+				if (context.ShouldStop(iteration))
+					return TimedOut(std::move(bestSeen.figuresPositions), startTime, generatedStatesCount);
 
-						auto currentState = std::move(GenerateState(bestFit->figuresPositions, result.position, heuristic));
-						generatedStatesCount++;
+				TraceSpan iterationSpan("Tabu iteration");
+				stats.CountIteration();
 
-						if (tabuList.find(currentState.Serialize()) != tabuList.end())
-							continue;
+				{
+					TraceSpan neighbourhoodSpan("Tabu neighbourhood");
 
-						fitnessQueue.push(currentState);
+					counters.Reset(bestFit->figuresPositions);
+
+					for (int col = 0; col < static_cast<int>(counters.Size()); col++) {
+
+						for (int row = 0; row < static_cast<int>(counters.Size()); row++) {
+
+							auto currentState = std::move(GenerateState(counters, bestFit->hash, { col, row }, heuristic));
+							generatedStatesCount++;
+							stats.CountHeuristicEvaluations();
+
+							bool tabu = tabuList.Contains(currentState.hash);
+							stats.CountVisitedLookup(tabu);
+
+							if (tabu)
+								continue;
+
+							fitnessQueue.push(currentState);
+							stats.CountQueuePushes();
+						}
 					}
 				}
 
+				TraceSpan selectionSpan("Tabu selection");
+				stats.CountFrontierSize(fitnessQueue.size());
+
 				SearchState localBestFit = fitnessQueue.top();
 				fitnessQueue.pop();
+				stats.CountQueuePops();
 
 				if (localBestFit < *bestFit)
 					*bestFit = localBestFit;
 
 				else {
+					// Empty when the queue runs dry, which ends the search unsolved.
 					SearchState localSecondBestFit;
-					
+
 					for (uint64_t i = 0; i < popDepth && !fitnessQueue.empty(); i++) {
 						localSecondBestFit = fitnessQueue.top();
 						fitnessQueue.pop();
+						stats.CountQueuePops();
 					}
 
 					*bestFit = localSecondBestFit;
-					tabuList.insert({ localBestFit.Serialize(), true });
+					tabuList.Insert(localBestFit.hash);
 
 					popDepth++;
 				}
-				
-				if (tabuList.size() > tabuListMaxSize)
-					tabuList.erase(tabuList.begin());
+
+				if (*bestFit < bestSeen)
+					bestSeen = *bestFit;
 			}
 
 			if (bestFit->heuristicValue != 0)
-				return { {}, TakeTimeStamp(startTime), generatedStatesCount };
-			
-			return {
-				bestFit->figuresPositions,
-				TakeTimeStamp(startTime),
-				generatedStatesCount,
-			};
+				return Unsolved(startTime, generatedStatesCount);
+
+			return Solved(bestFit->figuresPositions, startTime, generatedStatesCount);
+		}
+
+		// Classic attribute based tabu search. Every iteration applies the best
+		// move that is not tabu, unless it leads to the best board seen so far, and
+		// forbids moving the figure back to the row it left for param iterations.
+		template<uint32_t N>
+		Solution SolveMoves(
+			const Board& figuresPositions,
+			const SolverParam& param,
+			const std::shared_ptr<Heuristic> heuristic,
+			const SolveContext& context,
+			SolverStatsCounter& stats
+		) {
+			auto startTime = HighResClock::now();
+			uint64_t generatedStatesCount = 0;
+			uint64_t movesCount = 0;
+
+			const uint64_t tenure = static_cast<uint64_t>(std::max(param.value, 0));
+			const uint64_t maxIterations = TABU_MOVES_ITERATIONS_PER_FIGURE * figuresPositions.Size();
+
+			std::mt19937_64 randomEngine(context.seed);
+
+			BasicThreatCounters<N> counters(figuresPositions, context.figure);
+			TabuMoves tabuMoves(counters.Size());
+
+			uint32_t currentValue = heuristic->EvaluateBoard(counters);
+			stats.CountHeuristicEvaluations();
+			uint32_t bestValue = currentValue;
+			Board bestPositions(counters.Positions());
+
+			for (uint64_t iteration = 0; currentValue != 0 && iteration < maxIterations; iteration++) {
+
+				context.ReportProgress(iteration, bestValue);
+
+				if (context.ShouldStop(iteration))
+					return TimedOut(std::move(bestPositions), startTime, generatedStatesCount, movesCount);
+
+				TraceSpan iterationSpan("Tabu iteration");
+				stats.CountIteration();
+
+				uint32_t moveValue = UINT32_MAX;
+				uint32_t moveCol = 0;
+				uint32_t moveRow = 0;
+				uint32_t tiesCount = 0;
+
+				for (uint32_t col = 0; col < counters.Size(); col++) {
+					uint32_t currentRow = counters.Positions().Row(col);
+
+					for (uint32_t row = 0; row < counters.Size(); row++) {
+						if (row == currentRow)
+							continue;
+
+						uint32_t value = heuristic->EvaluateMove(counters, col, row);
+						generatedStatesCount++;
+						stats.CountHeuristicEvaluations();
+
+						bool tabu = tabuMoves.IsTabu(col, row, iteration);
+						stats.CountVisitedLookup(tabu);
+
+						if (tabu && value >= bestValue)
+							continue;
+
+						if (value < moveValue)
+							tiesCount = 1;
+
+						else if (value > moveValue || randomEngine() % ++tiesCount != 0)
+							continue;
+
+						moveValue = value;
+						moveCol = col;
+						moveRow = row;
+					}
+				}
+
+				if (moveValue == UINT32_MAX)
+					continue;
+
+				tabuMoves.Forbid(moveCol, counters.Positions().Row(moveCol), iteration, tenure);
+				counters.Move(moveCol, moveRow);
+				movesCount++;
+
+				currentValue = moveValue;
+
+				if (currentValue < bestValue) {
+					bestValue = currentValue;
+					bestPositions = counters.Positions();
+				}
+			}
+
+			if (currentValue != 0)
+				return Unsolved(startTime, generatedStatesCount, movesCount);
+
+			return Solved(counters.Positions(), startTime, generatedStatesCount, movesCount);
 		}
 	};
 }
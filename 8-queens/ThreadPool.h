@@ -0,0 +1,162 @@
+#pragma once
+#include "AllocationTracking.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace ntf {
+
+    // Fixed set of worker threads fed from a shared queue. The thread that calls
+    // ParallelFor works on the chunks as well, so a pool of threadsCount - 1
+    // workers keeps threadsCount cores busy, and nested calls cannot deadlock.
+    // Chunks are only offered to idle workers, so a ParallelFor nested in busy
+    // workers runs on its caller instead of queueing up behind them.
+    class ThreadPool
+    {
+    private:
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> tasks;
+        std::mutex tasksMutex;
+        std::condition_variable tasksAvailable;
+        size_t idleWorkersCount;
+        bool stopping;
+
+        struct ParallelForState {
+            std::atomic<size_t> nextChunk{ 0 };
+            std::atomic<size_t> finishedCount{ 0 };
+            std::mutex doneMutex;
+            std::condition_variable done;
+        };
+
+    public:
+        static size_t DefaultThreadsCount()
+        {
+            return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        explicit ThreadPool(size_t threadsCount = DefaultThreadsCount()) : workers{}, tasks{}, idleWorkersCount(0), stopping(false)
+        {
+            for (size_t i = 1; i < threadsCount; i++)
+                workers.emplace_back([this]() { Work(); });
+        }
+
+        // Pool of every hardware thread shared by the solvers and bulk tests of
+        // the process, so nesting them does not oversubscribe the cores.
+        static std::shared_ptr<ThreadPool> Shared()
+        {
+            static std::shared_ptr<ThreadPool> sharedPool(std::make_shared<ThreadPool>());
+            return sharedPool;
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator = (const ThreadPool&) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(tasksMutex);
+                stopping = true;
+            }
+
+            tasksAvailable.notify_all();
+
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        // Workers plus the calling thread.
+        size_t ThreadsCount() const { return workers.size() + 1; }
+
+        void Submit(std::function<void()> task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(tasksMutex);
+                tasks.push_back(std::move(task));
+            }
+
+            tasksAvailable.notify_one();
+        }
+
+        // Calls body(chunkIndex) for every chunk in [0, chunksCount) and returns
+        // once all of them are finished. Chunks are claimed in no particular order.
+        template<typename Body>
+        void ParallelFor(size_t chunksCount, Body&& body)
+        {
+            if (chunksCount == 0)
+                return;
+
+            if (chunksCount == 1 || workers.empty()) {
+                for (size_t i = 0; i < chunksCount; i++)
+                    body(i);
+                return;
+            }
+
+            auto state = std::make_shared<ParallelForState>();
+
+            // Allocations of the helpers count towards the scope of the caller.
+            auto runChunks = [state, chunksCount, &body, allocationCounters = CurrentAllocationCounters()]() {
+                AllocationScope allocationScope(allocationCounters);
+                size_t chunk;
+
+                while ((chunk = state->nextChunk.fetch_add(1)) < chunksCount) {
+                    body(chunk);
+
+                    if (state->finishedCount.fetch_add(1) + 1 == chunksCount) {
+                        std::lock_guard<std::mutex> lock(state->doneMutex);
+                        state->done.notify_all();
+                    }
+                }
+            };
+
+            // Helpers that start after every chunk was claimed return right away,
+            // so the body is never called after ParallelFor returned.
+            size_t helpersCount = std::min(AvailableWorkersCount(), chunksCount - 1);
+
+            for (size_t i = 0; i < helpersCount; i++)
+                Submit(runChunks);
+
+            runChunks();
+
+            std::unique_lock<std::mutex> lock(state->doneMutex);
+            state->done.wait(lock, [&]() { return state->finishedCount.load() == chunksCount; });
+        }
+
+    private:
+        // Idle workers not yet claimed by queued tasks.
+        size_t AvailableWorkersCount()
+        {
+            std::lock_guard<std::mutex> lock(tasksMutex);
+            return idleWorkersCount > tasks.size() ? idleWorkersCount - tasks.size() : 0;
+        }
+
+        void Work()
+        {
+            while (true) {
+                std::function<void()> task;
+
+                {
+                    std::unique_lock<std::mutex> lock(tasksMutex);
+
+                    idleWorkersCount++;
+                    tasksAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                    idleWorkersCount--;
+
+                    if (stopping && tasks.empty())
+                        return;
+
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+
+                task();
+            }
+        }
+    };
+}
@@ -0,0 +1,264 @@
+#pragma once
+#include "AttackTable.h"
+#include "Board.h"
+#include <array>
+#include <type_traits>
+
+
+namespace ntf {
+    constexpr uint32_t DYNAMIC_BOARD_SIZE = 0U;
+    constexpr uint32_t MIN_STATIC_BOARD_SIZE = 4U;
+    constexpr uint32_t MAX_STATIC_BOARD_SIZE = 16U;
+    constexpr uint32_t STATIC_BOARD_SIZES_COUNT = MAX_STATIC_BOARD_SIZE - MIN_STATIC_BOARD_SIZE + 1;
+
+    constexpr bool IsStaticBoardSize(uint32_t size)
+    {
+        return size >= MIN_STATIC_BOARD_SIZE && size <= MAX_STATIC_BOARD_SIZE;
+    }
+
+    // Occupancy counters of rows, main diagonals and anti-diagonals of a board.
+    // Conflicts are counted as pairs of figures sharing a line, which is exactly
+    // what pairwise queen threat checks yield, but every query is O(1).
+    // Other figures count their attackers on the attack table of the figure, as
+    // the popcount of the square's mask ANDed with the occupied squares. Boards
+    // too large for a table fall back to checking every occupied column.
+    // With a static N the counters live in std::array and every loop and index
+    // computation is resolved at compile time.
+    template<uint32_t N>
+    class BasicThreatCounters
+    {
+    private:
+        static constexpr bool IS_STATIC = N != DYNAMIC_BOARD_SIZE;
+        static constexpr uint32_t STATIC_DIAGONALS_COUNT = IS_STATIC ? N * 2 - 1 : 1;
+        static constexpr uint32_t STATIC_OCCUPANCY_WORDS_COUNT = IS_STATIC ? WordsCountFor(N * N) : 1;
+
+        static_assert(N <= UINT8_MAX, "Static threat counters are stored as uint8_t");
+
+        using Counter = std::conditional_t<IS_STATIC, uint8_t, uint32_t>;
+        using Lines = std::conditional_t<IS_STATIC, std::array<Counter, IS_STATIC ? N : 1>, std::vector<Counter>>;
+        using Diagonals = std::conditional_t<IS_STATIC, std::array<Counter, STATIC_DIAGONALS_COUNT>, std::vector<Counter>>;
+        using Occupancy = std::conditional_t<IS_STATIC, std::array<uint64_t, STATIC_OCCUPANCY_WORDS_COUNT>, std::vector<uint64_t>>;
+
+        Board figuresPositions;
+        FigureKind figure;
+
+        Lines rows;
+        Diagonals diagonals;
+        Diagonals antiDiagonals;
+
+        // Occupied squares for the attack table, or occupied columns without one.
+        const AttackTable* attackTable;
+        Occupancy occupancy;
+
+        uint32_t conflictsCount;
+
+    public:
+        explicit BasicThreatCounters(FigureKind figure = FigureKind::QUEEN)
+            : figuresPositions{}, figure(figure), rows{}, diagonals{}, antiDiagonals{}, attackTable(nullptr), occupancy{}, conflictsCount(0)
+        {}
+
+        explicit BasicThreatCounters(const Board& figuresPositions, FigureKind figure = FigureKind::QUEEN) : BasicThreatCounters(figure)
+        {
+            Reset(figuresPositions);
+        }
+
+        void Reset(const Board& figuresPositions)
+        {
+            Clear(figuresPositions.Size());
+
+            for (uint32_t col = 0; col < Size(); col++)
+                Place(col, figuresPositions.Row(col));
+        }
+
+        // Empties the counters for a board of the given size. Figures are then
+        // added column by column with Place.
+        void Clear(uint32_t size)
+        {
+            conflictsCount = 0;
+
+            if (!UsesLines()) {
+                if (attackTable == nullptr || attackTable->Size() != size)
+                    attackTable = AttackTable::Get(figure, IS_STATIC ? N : size);
+
+                if constexpr (IS_STATIC)
+                    occupancy.fill(0);
+                else
+                    occupancy.assign(WordsCountFor(attackTable != nullptr ? size * size : size), 0);
+
+                figuresPositions = Board(IS_STATIC ? N : size);
+                return;
+            }
+
+            if constexpr (IS_STATIC) {
+                figuresPositions = Board(N);
+                rows.fill(0);
+                diagonals.fill(0);
+                antiDiagonals.fill(0);
+            }
+
+            else {
+                figuresPositions = Board(size);
+                rows.assign(size, 0);
+                diagonals.assign(size > 0 ? size * 2 - 1 : 0, 0);
+                antiDiagonals.assign(size > 0 ? size * 2 - 1 : 0, 0);
+            }
+        }
+
+        void Place(uint32_t col, uint32_t row)
+        {
+            if (!UsesLines()) {
+                conflictsCount += AttackersAt(col, row);
+                ToggleOccupied(col, row);
+
+                figuresPositions.SetRow(col, row);
+                return;
+            }
+
+            conflictsCount += rows[row]++;
+            conflictsCount += diagonals[DiagonalIndex(col, row)]++;
+            conflictsCount += antiDiagonals[AntiDiagonalIndex(col, row)]++;
+
+            figuresPositions.SetRow(col, row);
+        }
+
+        constexpr uint32_t Size() const
+        {
+            if constexpr (IS_STATIC)
+                return N;
+            else
+                return figuresPositions.Size();
+        }
+
+        const Board& Positions() const { return figuresPositions; }
+
+        FigureKind Figure() const { return figure; }
+
+        uint32_t ConflictsCount() const { return conflictsCount; }
+
+        // Figures on the lines crossing the square, its own column included. Figures
+        // without lines never threaten their own column, so it is AttackersAt for them.
+        uint32_t CountAt(uint32_t col, uint32_t row) const
+        {
+            if (!UsesLines())
+                return AttackersAt(col, row);
+
+            return rows[row] + diagonals[DiagonalIndex(col, row)] + antiDiagonals[AntiDiagonalIndex(col, row)];
+        }
+
+        // Figures outside of the given column that threaten the square.
+        uint32_t AttackersAt(uint32_t col, uint32_t row) const
+        {
+            if (!UsesLines())
+                return attackTable != nullptr ? TableAttackersAt(col, row) : ScanAttackersAt(col, row);
+
+            uint32_t attackers = CountAt(col, row);
+
+            if (figuresPositions.Row(col) == row)
+                attackers -= 3;
+
+            return attackers;
+        }
+
+        int32_t MoveDelta(uint32_t col, uint32_t row) const
+        {
+            uint32_t currentRow = figuresPositions.Row(col);
+
+            if (currentRow == row)
+                return 0;
+
+            return static_cast<int32_t>(AttackersAt(col, row)) - static_cast<int32_t>(AttackersAt(col, currentRow));
+        }
+
+        uint32_t ConflictsAfterMove(uint32_t col, uint32_t row) const
+        {
+            return static_cast<uint32_t>(static_cast<int32_t>(conflictsCount) + MoveDelta(col, row));
+        }
+
+        void Move(uint32_t col, uint32_t row)
+        {
+            uint32_t currentRow = figuresPositions.Row(col);
+
+            if (currentRow == row)
+                return;
+
+            conflictsCount = ConflictsAfterMove(col, row);
+
+            if (!UsesLines()) {
+                ToggleOccupied(col, currentRow);
+                ToggleOccupied(col, row);
+
+                figuresPositions.SetRow(col, row);
+                return;
+            }
+
+            rows[currentRow]--;
+            diagonals[DiagonalIndex(col, currentRow)]--;
+            antiDiagonals[AntiDiagonalIndex(col, currentRow)]--;
+
+            rows[row]++;
+            diagonals[DiagonalIndex(col, row)]++;
+            antiDiagonals[AntiDiagonalIndex(col, row)]++;
+
+            figuresPositions.SetRow(col, row);
+        }
+
+    private:
+        bool UsesLines() const
+        {
+            return figure == FigureKind::QUEEN;
+        }
+
+        uint32_t OccupancyWordsCount() const
+        {
+            if constexpr (IS_STATIC)
+                return STATIC_OCCUPANCY_WORDS_COUNT;
+            else
+                return static_cast<uint32_t>(occupancy.size());
+        }
+
+        uint32_t TableAttackersAt(uint32_t col, uint32_t row) const
+        {
+            const uint64_t* mask = attackTable->Mask(col, row);
+            uint32_t attackers = 0;
+
+            for (uint32_t i = 0; i < OccupancyWordsCount(); i++)
+                attackers += PopCount(mask[i] & occupancy[i]);
+
+            return attackers;
+        }
+
+        uint32_t ScanAttackersAt(uint32_t col, uint32_t row) const
+        {
+            uint32_t attackers = 0;
+
+            for (uint32_t otherCol = 0; otherCol < Size(); otherCol++) {
+                if ((occupancy[otherCol / 64] >> (otherCol % 64) & 1) == 0)
+                    continue;
+
+                int32_t dx = static_cast<int32_t>(otherCol) - static_cast<int32_t>(col);
+                int32_t dy = static_cast<int32_t>(figuresPositions.Row(otherCol)) - static_cast<int32_t>(row);
+
+                attackers += FigureThreatens(figure, dx, dy) ? 1 : 0;
+            }
+
+            return attackers;
+        }
+
+        void ToggleOccupied(uint32_t col, uint32_t row)
+        {
+            uint32_t bit = attackTable != nullptr ? attackTable->SquareIndex(col, row) : col;
+            occupancy[bit / 64] ^= 1ULL << (bit % 64);
+        }
+
+        uint32_t DiagonalIndex(uint32_t col, uint32_t row) const
+        {
+            return col + Size() - 1 - row;
+        }
+
+        uint32_t AntiDiagonalIndex(uint32_t col, uint32_t row) const
+        {
+            return col + row;
+        }
+    };
+    using ThreatCounters = BasicThreatCounters<DYNAMIC_BOARD_SIZE>;
+}
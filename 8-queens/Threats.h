@@ -0,0 +1,46 @@
+#pragma once
+#include "Bitboard.h"
+
+
+namespace ntf {
+
+    inline bool FigureAtPosIsThreat(const Square& posA, const Square& posB, FigureKind figure = FigureKind::QUEEN)
+    {
+        if (posA == posB)
+            return false;
+        return FigureThreatens(figure, posB.x - posA.x, posB.y - posA.y);
+    }
+
+    // Columns of the figures threatening the square, from a bitboard kept by the caller.
+    inline ColumnSet GetThreatsIndicesForPos(const Square& trgPos, const Bitboard& bitboard, FigureKind figure = FigureKind::QUEEN)
+    {
+        return ColumnSet(bitboard.Size(), bitboard.AttackersOf(trgPos.x, trgPos.y, figure));
+    }
+
+    // Boards up to 64 columns are answered from a bitboard built for the query,
+    // larger ones figure by figure. Repeated queries should keep a Bitboard.
+    inline ColumnSet GetThreatsIndicesForPos(const Square& trgPos, const Board& positions, FigureKind figure = FigureKind::QUEEN)
+    {
+        if (positions.Size() <= MAX_BITBOARD_SIZE)
+            return GetThreatsIndicesForPos(trgPos, Bitboard(positions), figure);
+
+        ColumnSet threats(positions.Size());
+
+        for (uint32_t i = 0; i < positions.Size(); i++) {
+            if (FigureAtPosIsThreat(trgPos, positions.Position(i), figure))
+                threats.Insert(i);
+        }
+
+        return threats;
+    }
+
+    inline ColumnSet GetThreatsIndices(const uint32_t trgIndex, const Board& positions, FigureKind figure = FigureKind::QUEEN)
+    {
+        return GetThreatsIndicesForPos(positions.Position(trgIndex), positions, figure);
+    }
+
+    inline ColumnSet GetThreatsIndices(const uint32_t trgIndex, const Board& positions, const Bitboard& bitboard, FigureKind figure = FigureKind::QUEEN)
+    {
+        return GetThreatsIndicesForPos(positions.Position(trgIndex), bitboard, figure);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+
+namespace ntf {
+
+    // Keeps the k smallest of the pushed items in a max-heap, so a candidate that
+    // cannot make it in is rejected by a single comparison with the heap top.
+    template<typename T>
+    class TopK
+    {
+    private:
+        std::vector<T> items;
+        size_t capacity;
+
+    public:
+        explicit TopK(size_t capacity = 0) : items{}, capacity(capacity)
+        {
+            items.reserve(capacity);
+        }
+
+        void Reset(size_t capacity)
+        {
+            this->capacity = capacity;
+            items.clear();
+            items.reserve(capacity);
+        }
+
+        size_t Size() const { return items.size(); }
+
+        size_t Capacity() const { return capacity; }
+
+        bool Empty() const { return items.empty(); }
+
+        bool Accepts(const T& item) const
+        {
+            return items.size() < capacity || (capacity > 0 && item < items.front());
+        }
+
+        bool Push(const T& item)
+        {
+            if (!Accepts(item))
+                return false;
+
+            if (items.size() == capacity) {
+                std::pop_heap(items.begin(), items.end());
+                items.back() = item;
+            }
+
+            else
+                items.push_back(item);
+
+            std::push_heap(items.begin(), items.end());
+            return true;
+        }
+
+        // Moves the kept items into the output in ascending order and empties the selection.
+        void SortInto(std::vector<T>& output)
+        {
+            std::sort_heap(items.begin(), items.end());
+            output.assign(items.begin(), items.end());
+            items.clear();
+        }
+    };
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Builds with NTF_TRACING defined to 1 record scoped spans of the solvers into
+// a Chrome trace (chrome://tracing, ui.perfetto.dev). Otherwise the spans are
+// empty and compile to nothing.
+#ifndef NTF_TRACING
+#define NTF_TRACING 0
+#endif
+
+
+namespace ntf {
+    constexpr bool TRACING_ENABLED = NTF_TRACING != 0;
+
+    // Spans past this amount are dropped, so a forgotten recording cannot eat the memory.
+    constexpr size_t TRACE_MAX_EVENTS_PER_THREAD = 1U << 20;
+
+    struct TraceEvent {
+        const char* name;
+        const char* category;
+        int64_t startNs;
+        int64_t durationNs;
+    };
+
+    // Collects the spans of all threads while recording. Every thread appends to
+    // a buffer of its own, whose lock is only contended while the trace is written.
+    class Tracer
+    {
+    private:
+        struct ThreadBuffer {
+            uint32_t threadId = 0;
+            std::mutex mutex;
+            std::vector<TraceEvent> events;
+        };
+
+        std::atomic<bool> recording{ false };
+        std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+        std::mutex buffersMutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+        ThreadBuffer& CurrentBuffer()
+        {
+            static thread_local std::shared_ptr<ThreadBuffer> buffer;
+
+            if (!buffer) {
+                buffer = std::make_shared<ThreadBuffer>();
+
+                std::lock_guard<std::mutex> lock(buffersMutex);
+                buffer->threadId = static_cast<uint32_t>(buffers.size() + 1);
+                buffers.push_back(buffer);
+            }
+
+            return *buffer;
+        }
+
+    public:
+        static Tracer& Instance()
+        {
+            static Tracer tracer;
+            return tracer;
+        }
+
+        bool IsRecording() const
+        {
+            return recording.load(std::memory_order_relaxed);
+        }
+
+        // Drops the spans of the previous recording.
+        void Start()
+        {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+
+            for (auto& buffer : buffers) {
+                std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+                buffer->events.clear();
+            }
+
+            recording.store(true, std::memory_order_relaxed);
+        }
+
+        void Stop()
+        {
+            recording.store(false, std::memory_order_relaxed);
+        }
+
+        int64_t NowNs() const
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+        }
+
+        void Record(const char* name, const char* category, int64_t startNs, int64_t endNs)
+        {
+            ThreadBuffer& buffer = CurrentBuffer();
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+
+            if (buffer.events.size() < TRACE_MAX_EVENTS_PER_THREAD)
+                buffer.events.push_back({ name, category, startNs, endNs - startNs });
+        }
+
+        // Writes the recorded spans as complete events of the Chrome trace event
+        // format, with timestamps in microseconds. Returns false if the file
+        // cannot be written.
+        bool WriteChromeTrace(const std::string& path)
+        {
+            std::FILE* file = std::fopen(path.c_str(), "w");
+
+            if (file == nullptr)
+                return false;
+
+            std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+            bool first = true;
+
+            std::lock_guard<std::mutex> lock(buffersMutex);
+
+            for (auto& buffer : buffers) {
+                std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+
+                for (auto& event : buffer->events) {
+                    std::fprintf(
+                        file,
+                        "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                        first ? "" : ",",
+                        event.name,
+                        event.category,
+                        event.startNs / 1000.0,
+                        event.durationNs / 1000.0,
+                        buffer->threadId
+                    );
+                    first = false;
+                }
+            }
+
+            std::fprintf(file, "\n]}\n");
+            return std::fclose(file) == 0;
+        }
+    };
+
+    // Records the time between its construction and destruction as a span of the
+    // current thread, if the tracer was recording when the span started. Names
+    // and categories must be string literals, they are written as they are.
+    class TraceSpan
+    {
+    private:
+        const char* name;
+        const char* category;
+        int64_t startNs;
+
+    public:
+        explicit TraceSpan(const char* name, const char* category = "solver") : name(name), category(category), startNs(-1)
+        {
+            if constexpr (TRACING_ENABLED) {
+                if (Tracer::Instance().IsRecording())
+                    startNs = Tracer::Instance().NowNs();
+            }
+        }
+
+        ~TraceSpan()
+        {
+            if constexpr (TRACING_ENABLED) {
+                if (startNs >= 0)
+                    Tracer::Instance().Record(name, category, startNs, Tracer::Instance().NowNs());
+            }
+        }
+
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator = (const TraceSpan&) = delete;
+    };
+}
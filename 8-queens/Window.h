@@ -1,12 +1,17 @@
 #pragma once
 #define OLC_PGE_APPLICATION
 #include "olcPixelGameEngine.h"
+#include "Trace.h"
+#include "RingBuffer.h"
+#include <chrono>
+#include <cstdio>
 
 
 namespace ntf {
     constexpr const char* APP_NAME = "8 Queens";
     constexpr const char* RESOURCE_PACK_NAME = "./8queens_res.dat";
     constexpr const char* RESOURCE_PACK_KEY = "G-r$y37mbS557ke_5?2r1!A";
+    constexpr const char* TRACE_FILE_NAME = "./8queens_trace.json";
 
     constexpr uint32_t DASHED_LINE_PATTERN = 0xF0F0F0F0;
 
@@ -21,6 +26,10 @@ namespace ntf {
 
     constexpr int CHAR_WIDTH = 8;
 
+    constexpr size_t PERF_HISTORY_SIZE = 120;
+    constexpr int PERF_GRAPH_HEIGHT_I = 24;
+    constexpr float PERF_GRAPH_MIN_SCALE_MS = 1000.0f / 30.0f;
+
     struct PositionI {
         int x;
         int y;
@@ -36,6 +45,29 @@ namespace ntf {
 
     class Window;
 
+    struct PerfTiming {
+        std::string name;
+        RingBuffer<float, PERF_HISTORY_SIZE> milliseconds;
+    };
+
+    // Measures its lifetime into Window::RecordTiming while the inspection mode
+    // is on, and costs a single branch otherwise. The name must outlive the scope.
+    class TimingScope
+    {
+    private:
+        Window& window;
+        const char* name;
+        bool enabled;
+        std::chrono::steady_clock::time_point startTime;
+
+    public:
+        TimingScope(Window& window, const char* name);
+        ~TimingScope();
+
+        TimingScope(const TimingScope&) = delete;
+        TimingScope& operator = (const TimingScope&) = delete;
+    };
+
     struct Theme : public std::enable_shared_from_this<Theme> {
         std::string name;
         std::string figuresFolder;
@@ -103,6 +135,12 @@ namespace ntf {
         olc::vi2d screenOptionsApproxSize;
         olc::ResourcePack* resourcePack;
 
+        // Shown by the inspection mode. Frame times are always kept, the other
+        // timings are only measured while the inspection mode is on.
+        RingBuffer<float, PERF_HISTORY_SIZE> frameTimes;
+        std::vector<PerfTiming> perfTimings;
+        std::vector<std::string> drawSelfTimingNames;
+
         Window(
             const std::vector<std::shared_ptr<Screen>>& screens,
             const std::vector<std::shared_ptr<Theme>>& themes,
@@ -181,6 +219,7 @@ namespace ntf {
         bool OnUserCreate() override {
             for (auto& screen : screens) {
                 screen->OnCreate(shared_from_this());
+                drawSelfTimingNames.push_back(screen->name + " DrawSelf");
                 
                 if (screen->name.size() > screenOptionsApproxSize.x)
                     screenOptionsApproxSize.x = static_cast<int>(screen->name.size() * 16) + 12;
@@ -192,6 +231,7 @@ namespace ntf {
         bool OnUserUpdate(float fElapsedTime) override
         {
             Clear(BgColor());
+            frameTimes.Push(fElapsedTime * 1000.0f);
 
             for (uint32_t i = 0; i < screens.size(); i++) {
                 if (GetKey(screens[i]->key).bPressed)
@@ -204,6 +244,18 @@ namespace ntf {
             if (GetKey(olc::CTRL).bHeld && GetKey(olc::SHIFT).bHeld && GetKey(olc::I).bPressed)
                 inspectionModeToggled = !inspectionModeToggled;
 
+            // The trace is written once the recording is stopped.
+            if constexpr (TRACING_ENABLED) {
+                if (GetKey(olc::CTRL).bHeld && GetKey(olc::SHIFT).bHeld && GetKey(olc::E).bPressed) {
+                    if (Tracer::Instance().IsRecording()) {
+                        Tracer::Instance().Stop();
+                        Tracer::Instance().WriteChromeTrace(TRACE_FILE_NAME);
+                    }
+                    else
+                        Tracer::Instance().Start();
+                }
+            }
+
             DrawString({ TITLE_POSITION.x, TITLE_POSITION.y }, CurrentScreen()->name, FgColor());
 
             if (inspectionModeToggled) {
@@ -213,8 +265,92 @@ namespace ntf {
                 FillRect(pos, Window::Pad(Window::CalcStringSize(str)), olc::BLUE);
                 DrawString(Window::Pad(pos), str, olc::WHITE);
             }
-            
-            return CurrentScreen()->DrawSelf(fElapsedTime);
+
+            if (Tracer::Instance().IsRecording()) {
+                std::string str = "Tracing";
+                olc::vi2d pos = { ScreenWidth() - Window::Pad(Window::CalcStringSize(str)).x - BASE_GAP_I, ScreenHeight() - STRING_HEIGHT_I - BASE_GAP_I * 2 };
+
+                FillRect(pos, Window::Pad(Window::CalcStringSize(str)), olc::RED);
+                DrawString(Window::Pad(pos), str, olc::WHITE);
+            }
+
+            bool keepRunning = true;
+
+            {
+                TraceSpan frameSpan("Frame", "ui");
+                TimingScope drawSelfTiming(*this, drawSelfTimingNames.at(currentScreenIndex).c_str());
+
+                keepRunning = CurrentScreen()->DrawSelf(fElapsedTime);
+            }
+
+            if (inspectionModeToggled)
+                DrawPerformanceOverlay();
+
+            return keepRunning;
+        }
+
+        // Keeps the timing of a part of the frame for the performance overlay.
+        void RecordTiming(const char* name, float milliseconds)
+        {
+            for (auto& timing : perfTimings) {
+                if (timing.name == name) {
+                    timing.milliseconds.Push(milliseconds);
+                    return;
+                }
+            }
+
+            perfTimings.push_back({ name, {} });
+            perfTimings.back().milliseconds.Push(milliseconds);
+        }
+
+        // Graph of the recent frame times and averages of the recorded timings,
+        // drawn above the inspection mode label.
+        void DrawPerformanceOverlay()
+        {
+            std::vector<std::string> strings{
+                "Frame: " + FormatMilliseconds(frameTimes.Average()) + ", max " + FormatMilliseconds(frameTimes.Max()),
+            };
+
+            for (auto& timing : perfTimings)
+                strings.push_back(timing.name + ": " + FormatMilliseconds(timing.milliseconds.Average()));
+
+            olc::vi2d size = { static_cast<int>(PERF_HISTORY_SIZE) + BASE_GAP_I * 2, PERF_GRAPH_HEIGHT_I + BASE_GAP_I * 3 };
+
+            for (auto& string : strings) {
+                size.x = std::max(size.x, CalcStringWidth(string) + BASE_GAP_I);
+                size.y += STRING_HEIGHT_I;
+            }
+
+            olc::vi2d position = { BASE_GAP_I, ScreenHeight() - STRING_HEIGHT_I - BASE_GAP_I * 3 - size.y };
+            olc::vi2d graphPosition = { position.x + BASE_GAP_I, position.y + BASE_GAP_I };
+
+            FillRect(position, size, olc::BLUE);
+            DrawBarGraph(graphPosition, PERF_GRAPH_HEIGHT_I, 1, frameTimes, frameTimes.Size(), std::max(frameTimes.Max(), PERF_GRAPH_MIN_SCALE_MS), olc::WHITE);
+
+            for (size_t i = 0; i < strings.size(); i++)
+                DrawString({ graphPosition.x, graphPosition.y + PERF_GRAPH_HEIGHT_I + BASE_GAP_I + static_cast<int>(i) * STRING_HEIGHT_I }, strings[i], olc::WHITE);
+        }
+
+        // One bar per value, scaled so that maxValue fills the height.
+        template<typename Values>
+        void DrawBarGraph(
+            const olc::vi2d& position,
+            int height,
+            int barWidth,
+            const Values& values,
+            size_t valuesCount,
+            float maxValue,
+            const olc::Pixel& color
+        ) {
+            if (maxValue <= 0.0f)
+                return;
+
+            for (size_t i = 0; i < valuesCount; i++) {
+                int barHeight = static_cast<int>(std::min(static_cast<float>(values[i]) / maxValue, 1.0f) * height);
+
+                if (barHeight > 0)
+                    FillRect({ position.x + static_cast<int>(i) * barWidth, position.y + height - barHeight }, { barWidth, barHeight }, color);
+            }
         }
 
         BoundingRect DrawTextBox(
@@ -344,5 +480,24 @@ namespace ntf {
         {
             return { CalcStringWidth(string), STRING_HEIGHT_I };
         }
+
+        static std::string FormatMilliseconds(float milliseconds)
+        {
+            char formatted[32];
+            std::snprintf(formatted, sizeof(formatted), "%.2f ms", milliseconds);
+            return formatted;
+        }
     };
+
+    inline TimingScope::TimingScope(Window& window, const char* name) : window(window), name(name), enabled(window.inspectionModeToggled), startTime{}
+    {
+        if (enabled)
+            startTime = std::chrono::steady_clock::now();
+    }
+
+    inline TimingScope::~TimingScope()
+    {
+        if (enabled)
+            window.RecordTiming(name, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+    }
 }
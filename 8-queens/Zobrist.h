@@ -0,0 +1,32 @@
+#pragma once
+#include "Board.h"
+#include "Random.h"
+
+
+namespace ntf {
+    constexpr uint64_t ZOBRIST_SEED = 0x9E3779B97F4A7C15ULL;
+
+    // Zobrist key of a figure standing on the given square. Keys are derived with
+    // splitmix64 instead of a lookup table, so they exist for any board size.
+    inline uint64_t ZobristKey(uint32_t col, uint32_t row)
+    {
+        return SplitMix64(((static_cast<uint64_t>(col) << 32) | row) + ZOBRIST_SEED);
+    }
+
+    inline uint64_t ZobristHash(const Board& figuresPositions)
+    {
+        uint64_t hash = 0;
+
+        for (uint32_t i = 0; i < figuresPositions.Size(); i++)
+            hash ^= ZobristKey(i, figuresPositions.Row(i));
+
+        return hash;
+    }
+
+    inline uint64_t ZobristMove(uint64_t hash, uint32_t col, uint32_t fromRow, uint32_t toRow)
+    {
+        if (fromRow == toRow)
+            return hash;
+        return hash ^ ZobristKey(col, fromRow) ^ ZobristKey(col, toRow);
+    }
+}
@@ -1,8 +1,12 @@
+#define NTF_ALLOCATION_TRACKING_IMPLEMENTATION
 #include "ChessBoard.h"
 #include "HelpScreen.h"
 #include "MenuScreen.h"
 #include "BeamSearch.h"
 #include "TabuSearch.h"
+#include "MinConflicts.h"
+#include "Backtracking.h"
+#include "Portfolio.h"
 #include "LocalThreats.h"
 #include "GlobalThreats.h"
 
@@ -22,7 +26,27 @@ int main()
 		ntf::SolverParam{ true, "Tabu list max size", 2, 1000, 16, 16, }
 	));
 
-	std::vector<std::shared_ptr<ntf::Solver>> solvers{ beamSearch, tabuSearch };
+	std::shared_ptr<ntf::Solver> tabuMovesSearch(std::make_shared<ntf::TabuSearch>(
+		ntf::SolverParam{ true, "Tabu tenure", 1, 1000, 8, 8, },
+		ntf::TabuMode::MOVES
+	));
+
+	std::shared_ptr<ntf::Solver> minConflicts(std::make_shared<ntf::MinConflicts>(
+		ntf::SolverParam{ true, "Samples per move", 1, 1000, 32, 32, }
+	));
+
+	// Members get fixed params of their own. Beam members expand on the cores the
+	// portfolio leaves idle.
+	std::shared_ptr<ntf::Solver> portfolio(std::make_shared<ntf::Portfolio>(std::vector<std::shared_ptr<ntf::Solver>>{
+		std::make_shared<ntf::BeamSearch>(ntf::SolverParam{ true, "K param", 2, 1000, 16, 16, }),
+		std::make_shared<ntf::BeamSearch>(ntf::SolverParam{ true, "K param", 2, 1000, 48, 48, }),
+		std::make_shared<ntf::TabuSearch>(ntf::SolverParam{ true, "Tabu list max size", 2, 1000, 16, 16, }),
+		std::make_shared<ntf::TabuSearch>(ntf::SolverParam{ true, "Tabu tenure", 1, 1000, 8, 8, }, ntf::TabuMode::MOVES),
+	}));
+
+	std::shared_ptr<ntf::Solver> backtracking(std::make_shared<ntf::Backtracking>());
+
+	std::vector<std::shared_ptr<ntf::Solver>> solvers{ beamSearch, tabuSearch, tabuMovesSearch, minConflicts, portfolio, backtracking };
 
 	std::shared_ptr<ntf::Screen> board(std::make_shared<ntf::ChessBoard>(heuristics, solvers));
 	std::shared_ptr<ntf::Screen> help(std::make_shared<ntf::HelpScreen>());